@@ -92,6 +92,61 @@ esp_err_t dht_read_data(dht_sensor_type_t sensor_type, gpio_num_t pin,
 esp_err_t dht_read_float_data(dht_sensor_type_t sensor_type, gpio_num_t pin,
         float *humidity, float *temperature);
 
+/**
+ * Sensor handle for the RMT capture mode
+ */
+typedef struct dht_rmt_sensor *dht_rmt_handle_t;
+
+/**
+ * @brief Set up a sensor for reading through the RMT receiver
+ *
+ * Unlike dht_read_data(), reads through the handle never disable interrupts:
+ * the start pulse is timed with a task delay and the reply is captured by
+ * the RMT RX peripheral while the calling task sleeps. Needs one free RMT
+ * RX channel.
+ *
+ * @param pin GPIO pin connected to sensor OUT
+ * @param[out] handle Sensor handle
+ * @return `ESP_OK` on success, `ESP_ERR_NOT_SUPPORTED` if the target has no RMT
+ */
+esp_err_t dht_rmt_init(gpio_num_t pin, dht_rmt_handle_t *handle);
+
+/**
+ * @brief Release the RMT channel of a sensor
+ *
+ * @param handle Sensor handle
+ * @return `ESP_OK` on success
+ */
+esp_err_t dht_rmt_free(dht_rmt_handle_t handle);
+
+/**
+ * @brief Read integer data from sensor using the RMT receiver
+ *
+ * Same results as dht_read_data().
+ *
+ * @param handle Sensor handle
+ * @param sensor_type DHT11 or DHT22
+ * @param[out] humidity Humidity, percents * 10, nullable
+ * @param[out] temperature Temperature, degrees Celsius * 10, nullable
+ * @return `ESP_OK` on success
+ */
+esp_err_t dht_rmt_read_data(dht_rmt_handle_t handle, dht_sensor_type_t sensor_type,
+        int16_t *humidity, int16_t *temperature);
+
+/**
+ * @brief Read float data from sensor using the RMT receiver
+ *
+ * Same results as dht_read_float_data().
+ *
+ * @param handle Sensor handle
+ * @param sensor_type DHT11 or DHT22
+ * @param[out] humidity Humidity, percents, nullable
+ * @param[out] temperature Temperature, degrees Celsius, nullable
+ * @return `ESP_OK` on success
+ */
+esp_err_t dht_rmt_read_float_data(dht_rmt_handle_t handle, dht_sensor_type_t sensor_type,
+        float *humidity, float *temperature);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,276 @@
+/**
+ * @file dht_rmt.c
+ *
+ * RMT capture mode for the DHT driver
+ *
+ * The bit-banged reader in dht.c polls the line inside a critical section,
+ * which keeps interrupts off for the whole ~25 ms transaction. Here the
+ * start pulse is timed with a task delay and the sensor's reply is recorded
+ * by the RMT receiver as a list of (level, duration) pulses, so the calling
+ * task sleeps and interrupts stay enabled throughout.
+ *
+ * BSD Licensed as described in the file LICENSE
+ */
+#include "dht.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <string.h>
+#include <stdlib.h>
+#include <esp_log.h>
+#include <esp_idf_lib_helpers.h>
+
+#if HELPER_TARGET_IS_ESP32 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <soc/soc_caps.h>
+#endif
+
+#if HELPER_TARGET_IS_ESP32 && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0) && SOC_RMT_SUPPORTED
+#define DHT_RMT_SUPPORTED 1
+#include <driver/rmt_rx.h>
+#include <esp_rom_sys.h>
+#else
+#define DHT_RMT_SUPPORTED 0
+#endif
+
+#define DHT_DATA_BITS 40
+#define DHT_DATA_BYTES (DHT_DATA_BITS / 8)
+
+// 1 tick = 1 us
+#define DHT_RMT_RESOLUTION_HZ 1000000
+// Reply is ~42 low/high pairs; one symbol holds one pair
+#define DHT_RMT_SYMBOLS 64
+// Shorter pulses are noise; a line idle for longer ends the reply
+#define DHT_RMT_MIN_PULSE_NS 1000
+#define DHT_RMT_IDLE_NS 200000
+// A high pulse longer than this is a '1' (~70 us), shorter a '0' (~26 us)
+#define DHT_RMT_ONE_THRESHOLD_US 48
+#define DHT_RMT_REPLY_TIMEOUT_MS 50
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static const char *TAG = "dht_rmt";
+
+#if DHT_RMT_SUPPORTED
+
+struct dht_rmt_sensor
+{
+    gpio_num_t pin;
+    rmt_channel_handle_t channel;
+    QueueHandle_t done_queue;
+    rmt_symbol_word_t symbols[DHT_RMT_SYMBOLS];
+};
+
+static bool dht_rmt_on_recv_done(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR((QueueHandle_t)user_ctx, edata, &woken);
+    return woken == pdTRUE;
+}
+
+esp_err_t dht_rmt_init(gpio_num_t pin, dht_rmt_handle_t *handle)
+{
+    CHECK_ARG(handle);
+
+    struct dht_rmt_sensor *sensor = calloc(1, sizeof(struct dht_rmt_sensor));
+    if (!sensor)
+        return ESP_ERR_NO_MEM;
+    sensor->pin = pin;
+
+    sensor->done_queue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
+    if (!sensor->done_queue)
+    {
+        free(sensor);
+        return ESP_ERR_NO_MEM;
+    }
+
+    rmt_rx_channel_config_t config = {
+        .gpio_num = pin,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DHT_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = DHT_RMT_SYMBOLS,
+    };
+    esp_err_t res = rmt_new_rx_channel(&config, &sensor->channel);
+    if (res == ESP_OK)
+    {
+        rmt_rx_event_callbacks_t callbacks = { .on_recv_done = dht_rmt_on_recv_done };
+        res = rmt_rx_register_event_callbacks(sensor->channel, &callbacks, sensor->done_queue);
+    }
+    if (res == ESP_OK)
+        res = rmt_enable(sensor->channel);
+    if (res != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to set up RMT receiver on GPIO %d: %s", pin, esp_err_to_name(res));
+        if (sensor->channel)
+            rmt_del_channel(sensor->channel);
+        vQueueDelete(sensor->done_queue);
+        free(sensor);
+        return res;
+    }
+
+    // The RX channel only enabled the input; the start pulse needs an
+    // open-drain output on the same pad, idle high
+    gpio_set_direction(pin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_level(pin, 1);
+
+    *handle = sensor;
+    return ESP_OK;
+}
+
+esp_err_t dht_rmt_free(dht_rmt_handle_t handle)
+{
+    CHECK_ARG(handle);
+
+    rmt_disable(handle->channel);
+    rmt_del_channel(handle->channel);
+    vQueueDelete(handle->done_queue);
+    free(handle);
+    return ESP_OK;
+}
+
+/**
+ * The capture starts somewhere in the sensor's response, so decode from the
+ * end: the last 40 high pulses before the line went idle are the data bits.
+ * The final symbol ends with a zero duration where the idle timeout hit.
+ */
+static esp_err_t dht_rmt_decode(const rmt_symbol_word_t *symbols, size_t count, uint8_t data[DHT_DATA_BYTES])
+{
+    uint16_t highs[DHT_RMT_SYMBOLS * 2];
+    size_t high_count = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (symbols[i].level0 && symbols[i].duration0)
+            highs[high_count++] = symbols[i].duration0;
+        if (symbols[i].level1 && symbols[i].duration1)
+            highs[high_count++] = symbols[i].duration1;
+    }
+
+    if (high_count < DHT_DATA_BITS)
+    {
+        ESP_LOGE(TAG, "Reply too short: %u high pulses", (unsigned)high_count);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memset(data, 0, DHT_DATA_BYTES);
+    const uint16_t *bits = highs + high_count - DHT_DATA_BITS;
+    for (int i = 0; i < DHT_DATA_BITS; i++)
+        data[i / 8] |= (bits[i] > DHT_RMT_ONE_THRESHOLD_US) << (7 - i % 8);
+
+    return ESP_OK;
+}
+
+static int16_t dht_rmt_convert_data(dht_sensor_type_t sensor_type, uint8_t msb, uint8_t lsb)
+{
+    int16_t data;
+
+    if (sensor_type == DHT_TYPE_DHT11)
+    {
+        data = msb * 10;
+    }
+    else
+    {
+        data = msb & 0x7F;
+        data <<= 8;
+        data |= lsb;
+        if (msb & BIT(7))
+            data = -data;       // convert it to negative
+    }
+
+    return data;
+}
+
+esp_err_t dht_rmt_read_data(dht_rmt_handle_t handle, dht_sensor_type_t sensor_type,
+        int16_t *humidity, int16_t *temperature)
+{
+    CHECK_ARG(handle);
+    CHECK_ARG(humidity || temperature);
+
+    uint8_t data[DHT_DATA_BYTES] = { 0 };
+    rmt_rx_done_event_data_t done;
+    rmt_receive_config_t receive_config = {
+        .signal_range_min_ns = DHT_RMT_MIN_PULSE_NS,
+        .signal_range_max_ns = DHT_RMT_IDLE_NS,
+    };
+
+    xQueueReset(handle->done_queue);
+
+    // Phase 'A': start pulse, slept through instead of spun
+    gpio_set_level(handle->pin, 0);
+    if (sensor_type == DHT_TYPE_SI7021)
+        esp_rom_delay_us(500);
+    else
+        vTaskDelay(pdMS_TO_TICKS(20) + 1);  // at least 20 ms whatever the tick phase
+
+    // Arm the receiver, then release the line; the sensor answers within 40 us
+    esp_err_t res = rmt_receive(handle->channel, handle->symbols, sizeof(handle->symbols), &receive_config);
+    gpio_set_level(handle->pin, 1);
+    if (res != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to start RMT receive: %s", esp_err_to_name(res));
+        return res;
+    }
+
+    if (xQueueReceive(handle->done_queue, &done, pdMS_TO_TICKS(DHT_RMT_REPLY_TIMEOUT_MS)) != pdTRUE)
+    {
+        ESP_LOGE(TAG, "No reply from sensor");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    res = dht_rmt_decode(done.received_symbols, done.num_symbols, data);
+    if (res != ESP_OK)
+        return res;
+
+    if (data[4] != ((data[0] + data[1] + data[2] + data[3]) & 0xFF))
+    {
+        ESP_LOGE(TAG, "Checksum failed, invalid data received from sensor");
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    if (humidity)
+        *humidity = dht_rmt_convert_data(sensor_type, data[0], data[1]);
+    if (temperature)
+        *temperature = dht_rmt_convert_data(sensor_type, data[2], data[3]);
+
+    return ESP_OK;
+}
+
+#else
+
+esp_err_t dht_rmt_init(gpio_num_t pin, dht_rmt_handle_t *handle)
+{
+    ESP_LOGE(TAG, "RMT capture is not supported on this target");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t dht_rmt_free(dht_rmt_handle_t handle)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t dht_rmt_read_data(dht_rmt_handle_t handle, dht_sensor_type_t sensor_type,
+        int16_t *humidity, int16_t *temperature)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
+
+esp_err_t dht_rmt_read_float_data(dht_rmt_handle_t handle, dht_sensor_type_t sensor_type,
+        float *humidity, float *temperature)
+{
+    CHECK_ARG(humidity || temperature);
+
+    int16_t i_humidity, i_temp;
+
+    esp_err_t res = dht_rmt_read_data(handle, sensor_type, humidity ? &i_humidity : NULL, temperature ? &i_temp : NULL);
+    if (res != ESP_OK)
+        return res;
+
+    if (humidity)
+        *humidity = i_humidity / 10.0;
+    if (temperature)
+        *temperature = i_temp / 10.0;
+
+    return ESP_OK;
+}
@@ -0,0 +1,38 @@
+//HostTest.hpp
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the host tests: a failed check is reported with its
+// line and counted, the test keeps going, and hostTestResult() turns the
+// count into the exit code run_host_tests.sh looks at.
+inline int hostTestFailures = 0;
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                         #condition);                                            \
+            ++hostTestFailures;                                                  \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                               \
+    do {                                                                         \
+        long long actualValue = (long long)(actual);                             \
+        long long expectedValue = (long long)(expected);                         \
+        if (actualValue != expectedValue) {                                      \
+            std::fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__,  \
+                         __LINE__, #actual, actualValue, expectedValue);         \
+            ++hostTestFailures;                                                  \
+        }                                                                        \
+    } while (0)
+
+inline int hostTestResult(const char* name) {
+    if (hostTestFailures == 0) {
+        std::printf("%s: all checks passed\n", name);
+        return 0;
+    }
+    std::printf("%s: %d checks failed\n", name, hostTestFailures);
+    return 1;
+}
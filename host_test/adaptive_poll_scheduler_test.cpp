@@ -0,0 +1,57 @@
+//adaptive_poll_scheduler_test.cpp
+#include "AdaptivePollScheduler.hpp"
+#include "HostTest.hpp"
+
+static constexpr uint32_t BURST_MS = 1000;
+static constexpr uint32_t INITIAL_MS = 3000;
+static constexpr uint32_t CEILING_MS = 30000;
+static constexpr uint32_t BURST_CYCLES = 2;
+static constexpr uint32_t CONTROL_CEILING_MS = 3000;
+
+// The cycle delay never exceeds the control ceiling while the pixel backoff
+// grows, and only on cycles that polled the pixels
+static void testPixelBackoffOnly() {
+    AdaptivePollScheduler scheduler(BURST_MS, INITIAL_MS, CEILING_MS, BURST_CYCLES, CONTROL_CEILING_MS);
+
+    CHECK_EQ(scheduler.nextIntervalMs(false, true), CONTROL_CEILING_MS);
+    CHECK_EQ(scheduler.getPixelIntervalMs(), 6000);
+    CHECK_EQ(scheduler.nextIntervalMs(false, false), CONTROL_CEILING_MS);
+    CHECK_EQ(scheduler.getPixelIntervalMs(), 6000);
+    scheduler.nextIntervalMs(false, true);
+    scheduler.nextIntervalMs(false, true);
+    scheduler.nextIntervalMs(false, true);
+    CHECK_EQ(scheduler.getPixelIntervalMs(), CEILING_MS);
+
+    AdaptivePollScheduler::Stats stats = scheduler.getStats();
+    CHECK_EQ(stats.currentIntervalMs, CONTROL_CEILING_MS);
+    CHECK_EQ(stats.pixelIntervalMs, CEILING_MS);
+    CHECK_EQ(stats.averageIntervalMs, CONTROL_CEILING_MS);
+    CHECK_EQ(stats.historyCount, 5);
+    for (uint32_t i = 0; i < stats.historyCount; ++i) {
+        CHECK_EQ(stats.history[i], CONTROL_CEILING_MS);
+    }
+}
+
+// A remote change drops both to the burst interval for BURST_CYCLES cycles
+static void testBurst() {
+    AdaptivePollScheduler scheduler(BURST_MS, INITIAL_MS, CEILING_MS, BURST_CYCLES, CONTROL_CEILING_MS);
+    scheduler.nextIntervalMs(false, true);
+
+    CHECK_EQ(scheduler.nextIntervalMs(true, true), BURST_MS);
+    CHECK_EQ(scheduler.nextIntervalMs(false, true), BURST_MS);
+    CHECK_EQ(scheduler.nextIntervalMs(false, true), BURST_MS);
+    CHECK_EQ(scheduler.nextIntervalMs(false, true), 2000);
+    CHECK_EQ(scheduler.nextIntervalMs(false, true), CONTROL_CEILING_MS);
+    CHECK_EQ(scheduler.getPixelIntervalMs(), 4000);
+
+    AdaptivePollScheduler::Stats stats = scheduler.getStats();
+    CHECK_EQ(stats.cycles, 6);
+    CHECK_EQ(stats.burstEntries, 1);
+    CHECK_EQ(stats.averageIntervalMs, (3000 + 1000 + 1000 + 1000 + 2000 + 3000) / 6);
+}
+
+int main() {
+    testPixelBackoffOnly();
+    testBurst();
+    return hostTestResult("adaptive_poll_scheduler_test");
+}
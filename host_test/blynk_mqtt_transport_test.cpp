@@ -0,0 +1,210 @@
+//blynk_mqtt_transport_test.cpp
+// Drives BlynkMqttTransport against an MQTT broker (mosquitto or
+// servers/mqtt_stub_broker.py), with a second client playing the Blynk app:
+//   blynk_mqtt_transport_test <broker uri> <token> [token the broker refuses]
+#include "BlynkMqttTransport.hpp"
+#include "HostTest.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// What the transport handed to the application
+struct Received {
+    std::mutex mutex;
+    std::map<int, std::string> pins;
+    int connects = 0;
+
+    std::string pin(int number) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pins.find(number);
+        return it == pins.end() ? std::string() : it->second;
+    }
+};
+
+static void onPinWrite(void* context, int pin, std::string_view value) {
+    Received* received = static_cast<Received*>(context);
+    std::lock_guard<std::mutex> lock(received->mutex);
+    received->pins[pin] = std::string(value);
+}
+
+static void onConnected(void* context) {
+    Received* received = static_cast<Received*>(context);
+    std::lock_guard<std::mutex> lock(received->mutex);
+    received->connects++;
+}
+
+// The Blynk side: answers get/ds from its stored values the way Blynk does,
+// and records what the device published to ds/<name>
+struct App {
+    esp_mqtt_client_handle_t client = nullptr;
+    std::mutex mutex;
+    std::map<std::string, std::string> datastreams{ { "V2", "0" }, { "V3", "1" }, { "V4", "55" } };
+    std::map<std::string, std::string> published;
+    int subscriptions = 0;
+    bool connected = false;
+
+    std::string value(const std::string& topic) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = published.find(topic);
+        return it == published.end() ? std::string() : it->second;
+    }
+
+    void write(const std::string& name, const std::string& value) {
+        std::string topic = "downlink/ds/" + name;
+        esp_mqtt_client_publish(client, topic.c_str(), value.data(), static_cast<int>(value.size()), 1, 0);
+    }
+};
+
+static void appEventHandler(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData) {
+    App* app = static_cast<App*>(handlerArgs);
+    const esp_mqtt_event_t* event = static_cast<const esp_mqtt_event_t*>(eventData);
+
+    switch (static_cast<esp_mqtt_event_id_t>(eventId)) {
+        case MQTT_EVENT_CONNECTED:
+            esp_mqtt_client_subscribe_single(app->client, "get/ds", 1);
+            esp_mqtt_client_subscribe_single(app->client, "ds/#", 1);
+            break;
+
+        case MQTT_EVENT_SUBSCRIBED: {
+            std::lock_guard<std::mutex> lock(app->mutex);
+            app->connected = ++app->subscriptions >= 2;
+            break;
+        }
+
+        case MQTT_EVENT_DATA: {
+            std::string topic(event->topic, event->topic_len);
+            std::string payload(event->data, event->data_len);
+            if (topic != "get/ds") {
+                std::lock_guard<std::mutex> lock(app->mutex);
+                app->published[topic] = payload;
+                break;
+            }
+            // Comma separated datastream names
+            payload += ',';
+            for (size_t start = 0, end; (end = payload.find(',', start)) != std::string::npos; start = end + 1) {
+                std::string name = payload.substr(start, end - start);
+                std::string value;
+                {
+                    std::lock_guard<std::mutex> lock(app->mutex);
+                    auto it = app->datastreams.find(name);
+                    if (it == app->datastreams.end()) {
+                        continue;
+                    }
+                    value = it->second;
+                }
+                app->write(name, value);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+template <typename Predicate>
+static bool waitFor(Predicate predicate, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static void startApp(App& app, const std::string& brokerUri) {
+    esp_mqtt_client_config_t config = {};
+    config.broker.address.uri = brokerUri.c_str();
+    config.credentials.client_id = "host-test-app";
+    config.network.reconnect_timeout_ms = 500;
+    app.client = esp_mqtt_client_init(&config);
+    CHECK(app.client != nullptr);
+    esp_mqtt_client_register_event(app.client, MQTT_EVENT_ANY, appEventHandler, &app);
+    CHECK_EQ(esp_mqtt_client_start(app.client), ESP_OK);
+    CHECK(waitFor([&] { std::lock_guard<std::mutex> lock(app.mutex); return app.connected; }, 3000));
+}
+
+static void testSession(const std::string& brokerUri, const std::string& token) {
+    App app;
+    startApp(app, brokerUri);
+
+    Received received;
+    BlynkMqttTransport transport(brokerUri, token, 1);
+    transport.setHandlers(onPinWrite, onConnected, &received);
+    CHECK_EQ(transport.start(), ESP_OK);
+
+    CHECK(waitFor([&] { return transport.isConnected(); }, 3000));
+    CHECK(waitFor([&] { std::lock_guard<std::mutex> lock(received.mutex); return received.connects == 1; }, 1000));
+    CHECK_EQ(transport.getStats().connects, 1);
+    CHECK_EQ(transport.getStats().loginFailures, 0);
+    // The downlink/# subscription is sent from the connected handler; give the broker a moment
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // Resync: get/ds is answered with a downlink write per datastream
+    const int pins[] = { 3, 2, 4 };
+    CHECK_EQ(transport.syncVirtual(pins, 3), ESP_OK);
+    CHECK(waitFor([&] { return received.pin(4) == "55"; }, 2000));
+    CHECK(received.pin(3) == "1");
+    CHECK(received.pin(2) == "0");
+
+    // An app write arrives as a pin write
+    app.write("V2", "1");
+    CHECK(waitFor([&] { return received.pin(2) == "1"; }, 2000));
+
+    // A device write reaches the app on ds/V0 and its PUBACK is timed
+    uint32_t roundTrips = transport.getStats().roundTrips;
+    CHECK_EQ(transport.virtualWrite(0, "23.5"), ESP_OK);
+    CHECK(waitFor([&] { return app.value("ds/V0") == "23.5"; }, 2000));
+    CHECK(waitFor([&] { return transport.getStats().roundTrips == roundTrips + 1; }, 2000));
+
+    // PUBACK handled before esp_mqtt_client_publish() returns the msg id:
+    // the round trip must still be recorded, and shorter than the delay
+    esp_mqtt_host_set_publish_return_delay(150);
+    roundTrips = transport.getStats().roundTrips;
+    for (int i = 0; i < 3; ++i) {
+        std::string value = std::to_string(40 + i);
+        CHECK_EQ(transport.virtualWrite(5, value), ESP_OK);
+        CHECK(waitFor([&] { return app.value("ds/V5") == value; }, 2000));
+    }
+    esp_mqtt_host_set_publish_return_delay(0);
+    BlynkPushTransport::Stats stats = transport.getStats();
+    CHECK_EQ(stats.roundTrips, roundTrips + 3);
+    CHECK(stats.lastRoundTripMs < 150);
+
+    CHECK(stats.framesSent >= 5);       // sync and four writes
+    CHECK(stats.framesReceived >= 4);   // three values and the app write
+    std::printf("MQTT session: %u publishes acked, last round trip %u ms\n",
+                (unsigned)stats.roundTrips, (unsigned)stats.lastRoundTripMs);
+
+    esp_mqtt_client_destroy(app.client);
+}
+
+static void testRefusedToken(const std::string& brokerUri, const std::string& token) {
+    Received received;
+    BlynkMqttTransport transport(brokerUri, token, 1);
+    transport.setHandlers(onPinWrite, onConnected, &received);
+    CHECK_EQ(transport.start(), ESP_OK);
+
+    CHECK(waitFor([&] { return transport.getStats().loginFailures >= 1; }, 3000));
+    CHECK(!transport.isConnected());
+    CHECK_EQ(transport.getStats().connects, 0);
+    CHECK_EQ(transport.virtualWrite(0, "1"), ESP_ERR_INVALID_STATE);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3 && argc != 4) {
+        std::fprintf(stderr, "usage: %s <broker uri> <token> [token the broker refuses]\n", argv[0]);
+        return 2;
+    }
+
+    testSession(argv[1], argv[2]);
+    if (argc == 4) {
+        testRefusedToken(argv[1], argv[3]);
+    }
+    return hostTestResult("blynk_mqtt_transport_test");
+}
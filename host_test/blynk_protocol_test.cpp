@@ -0,0 +1,79 @@
+//blynk_protocol_test.cpp
+#include "BlynkProtocol.hpp"
+#include "HostTest.hpp"
+#include <cstring>
+#include <string_view>
+
+using namespace std::string_view_literals;
+
+static void testFrames() {
+    uint8_t frame[16];
+    size_t length = BlynkProtocol::encodeFrame(frame, sizeof(frame), BlynkProtocol::CMD_HW_LOGIN, 0x1234, "token"sv);
+    CHECK_EQ(length, BlynkProtocol::HEADER_SIZE + 5);
+    const uint8_t expected[] = { 29, 0x12, 0x34, 0x00, 0x05, 't', 'o', 'k', 'e', 'n' };
+    CHECK(memcmp(frame, expected, sizeof(expected)) == 0);
+
+    BlynkProtocol::Header header;
+    CHECK(BlynkProtocol::decodeHeader(frame, length, header));
+    CHECK_EQ(header.command, BlynkProtocol::CMD_HW_LOGIN);
+    CHECK_EQ(header.msgId, 0x1234);
+    CHECK_EQ(header.length, 5);
+    CHECK(!BlynkProtocol::decodeHeader(frame, BlynkProtocol::HEADER_SIZE - 1, header));
+
+    // Does not fit: nothing is written
+    CHECK_EQ(BlynkProtocol::encodeFrame(frame, 8, BlynkProtocol::CMD_HARDWARE, 1, "0123"sv), 0);
+
+    // Responses carry the status in the length field and have no body
+    length = BlynkProtocol::encodeResponse(frame, sizeof(frame), 0xBEEF, BlynkProtocol::STATUS_SUCCESS);
+    CHECK_EQ(length, BlynkProtocol::HEADER_SIZE);
+    CHECK(BlynkProtocol::decodeHeader(frame, length, header));
+    CHECK_EQ(header.command, BlynkProtocol::CMD_RESPONSE);
+    CHECK_EQ(header.msgId, 0xBEEF);
+    CHECK_EQ(header.length, 200);
+    CHECK_EQ(BlynkProtocol::encodeResponse(frame, 4, 1, 200), 0);
+}
+
+static void testBodies() {
+    char body[16];
+    size_t length = BlynkProtocol::buildVirtualWrite(body, sizeof(body), 12, "45.5"sv);
+    CHECK(std::string_view(body, length) == "vw\00012\00045.5"sv);
+    CHECK_EQ(BlynkProtocol::buildVirtualWrite(body, 8, 12, "45.5"sv), 0);
+
+    const int pins[] = { 3, 2, 4 };
+    length = BlynkProtocol::buildVirtualSync(body, sizeof(body), pins, 3);
+    CHECK(std::string_view(body, length) == "vr\0003\0002\0004"sv);
+    CHECK_EQ(BlynkProtocol::buildVirtualSync(body, sizeof(body), pins, 0), 0);
+    CHECK_EQ(BlynkProtocol::buildVirtualSync(body, 6, pins, 3), 0);
+}
+
+static void testParsing() {
+    int pin = -1;
+    std::string_view value;
+    CHECK(BlynkProtocol::parseVirtualWrite("vw\0003\0001"sv, pin, value));
+    CHECK_EQ(pin, 3);
+    CHECK(value == "1"sv);
+
+    // Arrays keep their first element, an empty value is still a write
+    CHECK(BlynkProtocol::parseVirtualWrite("vw\0007\000255\000128"sv, pin, value));
+    CHECK_EQ(pin, 7);
+    CHECK(value == "255"sv);
+    CHECK(BlynkProtocol::parseVirtualWrite("vw\0005"sv, pin, value));
+    CHECK(value.empty());
+
+    CHECK(!BlynkProtocol::parseVirtualWrite("dw\0003\0001"sv, pin, value));
+    CHECK(!BlynkProtocol::parseVirtualWrite("vw\000x3\0001"sv, pin, value));
+    CHECK(!BlynkProtocol::parseVirtualWrite("vw\000\0001"sv, pin, value));
+
+    std::string_view fields = "blynk.cloud\0008080"sv;
+    CHECK(BlynkProtocol::nextField(fields) == "blynk.cloud"sv);
+    CHECK(BlynkProtocol::nextField(fields) == "8080"sv);
+    CHECK(fields.empty());
+    CHECK(BlynkProtocol::nextField(fields).empty());
+}
+
+int main() {
+    testFrames();
+    testBodies();
+    testParsing();
+    return hostTestResult("blynk_protocol_test");
+}
@@ -0,0 +1,106 @@
+//blynk_tcp_transport_test.cpp
+// Drives BlynkTcpTransport against servers/blynk_stub_server.py:
+//   blynk_tcp_transport_test <entry port> <node port> <token>
+#include "BlynkTcpTransport.hpp"
+#include "HostTest.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// What the transport handed to the application
+struct Received {
+    std::mutex mutex;
+    std::map<int, std::string> pins;
+    int connects = 0;
+
+    std::string pin(int number) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pins.find(number);
+        return it == pins.end() ? std::string() : it->second;
+    }
+};
+
+static void onPinWrite(void* context, int pin, std::string_view value) {
+    Received* received = static_cast<Received*>(context);
+    std::lock_guard<std::mutex> lock(received->mutex);
+    received->pins[pin] = std::string(value);
+}
+
+static void onConnected(void* context) {
+    Received* received = static_cast<Received*>(context);
+    std::lock_guard<std::mutex> lock(received->mutex);
+    received->connects++;
+}
+
+template <typename Predicate>
+static bool waitFor(Predicate predicate, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+// Login on the entry port is redirected to the node, where the session runs
+static void testRedirectedSession(uint16_t entryPort, const std::string& token) {
+    Received received;
+    // The transport task never ends, so the transport outlives the test
+    BlynkTcpTransport* transport = new BlynkTcpTransport("127.0.0.1", entryPort, token);
+    transport->setHandlers(onPinWrite, onConnected, &received);
+    CHECK_EQ(transport->start(), ESP_OK);
+
+    CHECK(waitFor([&] { return transport->isConnected(); }, 3000));
+    BlynkPushTransport::Stats stats = transport->getStats();
+    CHECK_EQ(stats.connects, 1);
+    CHECK_EQ(stats.redirects, 1);
+    CHECK_EQ(stats.loginFailures, 0);
+    CHECK(waitFor([&] { std::lock_guard<std::mutex> lock(received.mutex); return received.connects == 1; }, 1000));
+
+    // Resync: the node pushes its stored values back as writes
+    const int pins[] = { 3, 2, 4 };
+    CHECK_EQ(transport->syncVirtual(pins, 3), ESP_OK);
+    CHECK(waitFor([&] { return received.pin(4) == "55"; }, 2000));
+    CHECK(received.pin(3) == "1");
+    CHECK(received.pin(2) == "0");
+
+    // A device write reaches the node, which echoes it on V31
+    CHECK_EQ(transport->virtualWrite(0, "23.5"), ESP_OK);
+    CHECK(waitFor([&] { return received.pin(31) == "0:23.5"; }, 2000));
+
+    stats = transport->getStats();
+    CHECK(stats.framesSent >= 4);       // login, info, sync, write
+    CHECK(stats.framesReceived >= 5);   // login answer, three values, echo
+}
+
+static void testRejectedToken(uint16_t nodePort) {
+    Received received;
+    BlynkTcpTransport* transport = new BlynkTcpTransport("127.0.0.1", nodePort, "wrong-token");
+    transport->setHandlers(onPinWrite, onConnected, &received);
+    CHECK_EQ(transport->start(), ESP_OK);
+
+    CHECK(waitFor([&] { return transport->getStats().loginFailures == 1; }, 3000));
+    BlynkPushTransport::Stats stats = transport->getStats();
+    CHECK(!transport->isConnected());
+    CHECK_EQ(stats.connects, 0);
+    CHECK_EQ(stats.redirects, 0);
+    CHECK_EQ(transport->virtualWrite(0, "1"), ESP_ERR_INVALID_STATE);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        std::fprintf(stderr, "usage: %s <entry port> <node port> <token>\n", argv[0]);
+        return 2;
+    }
+    uint16_t entryPort = static_cast<uint16_t>(std::atoi(argv[1]));
+    uint16_t nodePort = static_cast<uint16_t>(std::atoi(argv[2]));
+
+    testRedirectedSession(entryPort, argv[3]);
+    testRejectedToken(nodePort);
+    return hostTestResult("blynk_tcp_transport_test");
+}
@@ -0,0 +1,96 @@
+//circuit_breaker_test.cpp
+#include "CircuitBreaker.hpp"
+#include "HostTest.hpp"
+
+static constexpr uint32_t THRESHOLD = 3;
+static constexpr uint32_t BASE_OPEN_MS = 1000;
+static constexpr uint32_t MAX_OPEN_MS = 8000;
+
+// Failures below the threshold keep it closed, a success resets the count
+static void testStaysClosed() {
+    CircuitBreaker breaker(THRESHOLD, BASE_OPEN_MS, MAX_OPEN_MS);
+    CHECK_EQ(breaker.check(0), CircuitBreaker::ALLOW);
+    breaker.recordFailure(0);
+    breaker.recordFailure(10);
+    breaker.recordSuccess();
+    breaker.recordFailure(20);
+    breaker.recordFailure(30);
+    CHECK_EQ(breaker.getState(), CircuitBreaker::CLOSED);
+    CHECK_EQ(breaker.check(40), CircuitBreaker::ALLOW);
+    CHECK_EQ(breaker.getStats().opens, 0);
+}
+
+// CLOSED -> OPEN -> HALF_OPEN -> CLOSED
+static void testRecovers() {
+    CircuitBreaker breaker(THRESHOLD, BASE_OPEN_MS, MAX_OPEN_MS);
+    for (uint32_t i = 0; i < THRESHOLD; ++i) {
+        CHECK_EQ(breaker.check(100), CircuitBreaker::ALLOW);
+        breaker.recordFailure(100);
+    }
+    CHECK_EQ(breaker.getState(), CircuitBreaker::OPEN);
+    CHECK_EQ(breaker.getStats().opens, 1);
+
+    // Rejected without a request until the interval has passed
+    CHECK_EQ(breaker.check(100 + BASE_OPEN_MS - 1), CircuitBreaker::REJECT);
+    CHECK_EQ(breaker.getStats().rejected, 1);
+
+    // Exactly one probe is let through, the rest wait for its result
+    CHECK_EQ(breaker.check(100 + BASE_OPEN_MS), CircuitBreaker::PROBE);
+    CHECK_EQ(breaker.getState(), CircuitBreaker::HALF_OPEN);
+    CHECK_EQ(breaker.check(100 + BASE_OPEN_MS + 1), CircuitBreaker::REJECT);
+    CHECK_EQ(breaker.getStats().probes, 1);
+
+    breaker.recordSuccess();
+    CHECK_EQ(breaker.getState(), CircuitBreaker::CLOSED);
+    CHECK_EQ(breaker.check(100 + BASE_OPEN_MS + 2), CircuitBreaker::ALLOW);
+    CHECK_EQ(breaker.getStats().consecutiveFailures, 0);
+    CHECK_EQ(breaker.getOpenIntervalMs(), BASE_OPEN_MS);
+}
+
+// HALF_OPEN -> OPEN with the interval doubled up to the maximum
+static void testProbeFailureBacksOff() {
+    CircuitBreaker breaker(THRESHOLD, BASE_OPEN_MS, MAX_OPEN_MS);
+    uint32_t now = 0;
+    for (uint32_t i = 0; i < THRESHOLD; ++i) {
+        breaker.recordFailure(now);
+    }
+
+    const uint32_t expectedIntervals[] = { 2000, 4000, 8000, 8000 };
+    uint32_t interval = BASE_OPEN_MS;
+    for (uint32_t expected : expectedIntervals) {
+        now += interval;
+        CHECK_EQ(breaker.check(now), CircuitBreaker::PROBE);
+        breaker.recordFailure(now);
+        CHECK_EQ(breaker.getState(), CircuitBreaker::OPEN);
+        CHECK_EQ(breaker.getOpenIntervalMs(), expected);
+        CHECK_EQ(breaker.check(now + expected - 1), CircuitBreaker::REJECT);
+        interval = expected;
+    }
+    CHECK_EQ(breaker.getStats().opens, 5);
+
+    // A later recovery starts over from the base interval
+    now += interval;
+    CHECK_EQ(breaker.check(now), CircuitBreaker::PROBE);
+    breaker.recordSuccess();
+    for (uint32_t i = 0; i < THRESHOLD; ++i) {
+        breaker.recordFailure(now);
+    }
+    CHECK_EQ(breaker.getOpenIntervalMs(), BASE_OPEN_MS);
+}
+
+// The reopen time is compared wrap-safe across the 32-bit millisecond rollover
+static void testClockWrap() {
+    CircuitBreaker breaker(1, BASE_OPEN_MS, MAX_OPEN_MS);
+    uint32_t now = UINT32_MAX - 100;
+    breaker.recordFailure(now);
+    CHECK_EQ(breaker.check(now + 500), CircuitBreaker::REJECT);
+    CHECK_EQ(breaker.check(now + BASE_OPEN_MS), CircuitBreaker::PROBE);
+}
+
+int main() {
+    testStaysClosed();
+    testRecovers();
+    testProbeFailureBacksOff();
+    testClockWrap();
+    return hostTestResult("circuit_breaker_test");
+}
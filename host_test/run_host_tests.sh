@@ -0,0 +1,95 @@
+#!/bin/sh
+# Builds the host tests with plain g++ and runs them; no ESP-IDF needed.
+# Only pure logic and the POSIX-socket transports are compiled, the IDF and
+# FreeRTOS calls they make come from stubs/. Transport tests talk to the
+# stand-in servers in servers/, started here on local ports.
+set -u
+cd "$(dirname "$0")"
+
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++2b -O2 -Wall -Wextra -Wno-unused-parameter -pthread -I. -Istubs -I../main"
+BUILD=build
+BLYNK_ENTRY_PORT=${BLYNK_ENTRY_PORT:-18080}
+BLYNK_NODE_PORT=${BLYNK_NODE_PORT:-18081}
+TLS_PORT=${TLS_PORT:-18443}
+MQTT_PORT=${MQTT_PORT:-11883}
+# Set to a running mosquitto (mqtt://host:port, anonymous access) to test
+# against it instead of the stand-in broker
+MQTT_BROKER_URI=${MQTT_BROKER_URI:-}
+TOKEN=host-test-token
+
+mkdir -p "$BUILD"
+failed=0
+server_pid=
+
+build() {
+    name=$1
+    shift
+    if ! $CXX $CXXFLAGS "$@" -o "$BUILD/$name"; then
+        echo "$name: build failed"
+        failed=1
+        return 1
+    fi
+}
+
+run() {
+    "$BUILD/$@" || failed=1
+}
+
+# Starts a stand-in server and waits for its "ready" line
+start_server() {
+    log="$BUILD/$1.log"
+    shift
+    "$@" > "$log" 2>&1 &
+    server_pid=$!
+    for _ in 1 2 3 4 5 6 7 8 9 10; do
+        grep -q '^ready' "$log" && return 0
+        sleep 0.2
+    done
+    echo "server $* did not start:"
+    cat "$log"
+    failed=1
+    return 1
+}
+
+stop_server() {
+    [ -n "$server_pid" ] && kill "$server_pid" 2>/dev/null
+    server_pid=
+}
+trap stop_server EXIT
+
+build circuit_breaker_test circuit_breaker_test.cpp ../main/CircuitBreaker.cpp && run circuit_breaker_test
+build adaptive_poll_scheduler_test adaptive_poll_scheduler_test.cpp ../main/AdaptivePollScheduler.cpp && run adaptive_poll_scheduler_test
+build blynk_protocol_test blynk_protocol_test.cpp ../main/BlynkProtocol.cpp && run blynk_protocol_test
+build sensor_filter_test sensor_filter_test.cpp ../main/SensorFilter.cpp && run sensor_filter_test
+
+if build blynk_tcp_transport_test blynk_tcp_transport_test.cpp ../main/BlynkTcpTransport.cpp ../main/BlynkProtocol.cpp stubs/idf_posix.cpp \
+    && start_server blynk_stub_server python3 servers/blynk_stub_server.py --entry-port "$BLYNK_ENTRY_PORT" --node-port "$BLYNK_NODE_PORT" --token "$TOKEN"; then
+    run blynk_tcp_transport_test "$BLYNK_ENTRY_PORT" "$BLYNK_NODE_PORT" "$TOKEN"
+    stop_server
+fi
+
+if build blynk_mqtt_transport_test blynk_mqtt_transport_test.cpp ../main/BlynkMqttTransport.cpp stubs/mqtt_client_posix.cpp stubs/idf_posix.cpp; then
+    if [ -n "$MQTT_BROKER_URI" ]; then
+        run blynk_mqtt_transport_test "$MQTT_BROKER_URI" "$TOKEN"
+    elif start_server mqtt_stub_broker python3 servers/mqtt_stub_broker.py --port "$MQTT_PORT" --reject-password wrong-token; then
+        run blynk_mqtt_transport_test "mqtt://127.0.0.1:$MQTT_PORT" "$TOKEN" wrong-token
+        stop_server
+    fi
+fi
+
+build tls_handshake_stats_test tls_handshake_stats_test.cpp ../main/TlsHandshakeStats.cpp && run tls_handshake_stats_test
+
+if build blynk_https_session_test blynk_https_session_test.cpp ../main/BlynkHttpSession.cpp ../main/TlsHandshakeStats.cpp \
+        ../main/CircuitBreaker.cpp ../main/DnsCache.cpp stubs/esp_http_client_openssl.cpp stubs/idf_posix.cpp -lssl -lcrypto \
+    && start_server tls_stub_server servers/tls_stub_server.sh "$TLS_PORT" "$BUILD"; then
+    ./tls_resumption_check.sh "$TLS_PORT" "$BUILD" || failed=1
+    run blynk_https_session_test "$TLS_PORT" "$BUILD/tls_stub_cert.pem"
+    stop_server
+fi
+
+if [ "$failed" -ne 0 ]; then
+    echo "host tests FAILED"
+    exit 1
+fi
+echo "host tests passed"
@@ -0,0 +1,120 @@
+//sensor_filter_test.cpp
+// Fixed input vectors with their expected outputs for each filter type,
+// then a rough per-sample cost on this host:
+//   sensor_filter_test [samples per benchmark]
+#include "SensorFilter.hpp"
+#include "HostTest.hpp"
+#include <chrono>
+#include <cstdlib>
+
+// Tenths of a degree: steady around 20.0, a one-sample spike to 26.0,
+// then a step to 25.0 with noise
+static const int32_t STEP[] = { 200, 201, 199, 200, 260, 202, 201, 250, 251, 249, 250, 252 };
+static const int32_t BELOW_ZERO[] = { -15, -12, -18, -11, -14, -16 };
+static constexpr size_t STEP_COUNT = sizeof(STEP) / sizeof(STEP[0]);
+static constexpr size_t BELOW_ZERO_COUNT = sizeof(BELOW_ZERO) / sizeof(BELOW_ZERO[0]);
+
+static void checkOutputs(const SensorFilter::Config& config, const int32_t* input, const int32_t* expected,
+                         size_t count) {
+    SensorFilter filter;
+    filter.configure(config);
+    CHECK(!filter.hasValue());
+    for (size_t i = 0; i < count; ++i) {
+        int32_t output = filter.update(input[i]);
+        if (output != expected[i]) {
+            std::fprintf(stderr, "filter type %d, sample %zu (%d): got %d, expected %d\n", config.type, i,
+                         (int)input[i], (int)output, (int)expected[i]);
+            ++hostTestFailures;
+        }
+    }
+    CHECK(filter.hasValue());
+    CHECK_EQ(filter.getValue(), expected[count - 1]);
+}
+
+static void testNone() {
+    checkOutputs(SensorFilter::none(), STEP, STEP, STEP_COUNT);
+}
+
+// The spike never reaches the output; the step is followed after (window + 1) / 2 samples
+static void testMedian() {
+    const int32_t median3[] = { 200, 200, 200, 200, 200, 202, 202, 202, 250, 250, 250, 250 };
+    const int32_t median5[] = { 200, 200, 200, 200, 200, 201, 201, 202, 250, 249, 250, 250 };
+    checkOutputs(SensorFilter::median(3), STEP, median3, STEP_COUNT);
+    checkOutputs(SensorFilter::median(5), STEP, median5, STEP_COUNT);
+
+    // Even windows average the middle two, truncating toward zero
+    const int32_t median4[] = { -15, -13, -15, -13, -13, -15 };
+    checkOutputs(SensorFilter::median(4), BELOW_ZERO, median4, BELOW_ZERO_COUNT);
+
+    // Out of range windows are clamped
+    SensorFilter filter;
+    filter.configure(SensorFilter::median(0));
+    CHECK_EQ(filter.getConfig().window, 1);
+    filter.configure(SensorFilter::median(20));
+    CHECK_EQ(filter.getConfig().window, SensorFilter::MAX_WINDOW);
+}
+
+// Seeded by the first sample; within one tenth of the floating point EMA,
+// rounded half away from zero
+static void testEma() {
+    const int32_t quarter[] = { 200, 200, 200, 200, 215, 212, 209, 219, 227, 233, 237, 241 };
+    checkOutputs(SensorFilter::ema(8192), STEP, quarter, STEP_COUNT);
+
+    const int32_t half[] = { -15, -14, -16, -13, -14, -15 };
+    checkOutputs(SensorFilter::ema(16384), BELOW_ZERO, half, BELOW_ZERO_COUNT);
+
+    // Alpha 0 is taken as 1.0, which passes samples through
+    checkOutputs(SensorFilter::ema(0), STEP, STEP, STEP_COUNT);
+}
+
+static void testKalman() {
+    const int32_t step[] = { 200, 201, 200, 200, 216, 212, 210, 219, 226, 231, 235, 239 };
+    checkOutputs(SensorFilter::kalman(1, 16), STEP, step, STEP_COUNT);
+
+    const int32_t constant[] = { 230, 230, 230, 230, 230, 230 };
+    checkOutputs(SensorFilter::kalman(1, 16), constant, constant, 6);
+
+    // No measurement noise: the estimate is the sample
+    checkOutputs(SensorFilter::kalman(1, 0), STEP, STEP, STEP_COUNT);
+}
+
+static void testReset() {
+    SensorFilter filter;
+    filter.configure(SensorFilter::ema(8192));
+    filter.update(200);
+    filter.update(300);
+    filter.reset();
+    CHECK(!filter.hasValue());
+    CHECK_EQ(filter.update(100), 100);
+}
+
+static void benchmark(const char* name, const SensorFilter::Config& config, size_t samples) {
+    SensorFilter filter;
+    filter.configure(config);
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) {
+        sum += filter.update(STEP[i % STEP_COUNT]);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    // The sum keeps the loop from being optimized away
+    std::printf("%-9s %6.1f ns/sample (checksum %lld)\n", name, (double)elapsed.count() / samples, (long long)sum);
+}
+
+int main(int argc, char** argv) {
+    testNone();
+    testMedian();
+    testEma();
+    testKalman();
+    testReset();
+
+    size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    if (samples > 0) {
+        benchmark("none", SensorFilter::none(), samples);
+        benchmark("median 3", SensorFilter::median(3), samples);
+        benchmark("median 7", SensorFilter::median(SensorFilter::MAX_WINDOW), samples);
+        benchmark("ema", SensorFilter::ema(8192), samples);
+        benchmark("kalman", SensorFilter::kalman(1, 16), samples);
+    }
+    return hostTestResult("sensor_filter_test");
+}
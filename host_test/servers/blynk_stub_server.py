@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""Stand-in for a Blynk server speaking the binary hardware protocol.
+
+Two listeners: the "entry" port redirects every login to the "node" port,
+the way Blynk moves a device to its regional node; the node accepts one auth
+token and answers the rest with INVALID_TOKEN. On the node, a vr sync is
+answered by pushing the stored pin values, and every vw from the device is
+echoed back as a push to V31 ("<pin>:<value>"), so a client can see that
+both directions work.
+"""
+
+import argparse
+import socket
+import struct
+import threading
+
+CMD_RESPONSE = 0
+CMD_PING = 6
+CMD_HARDWARE_SYNC = 16
+CMD_INTERNAL = 17
+CMD_HARDWARE = 20
+CMD_HW_LOGIN = 29
+CMD_REDIRECT = 41
+
+STATUS_SUCCESS = 200
+STATUS_INVALID_TOKEN = 9
+
+ECHO_PIN = 31
+
+
+def frame(command, msg_id, body=b""):
+    return struct.pack(">BHH", command, msg_id, len(body)) + body
+
+
+def response(msg_id, status):
+    return struct.pack(">BHH", CMD_RESPONSE, msg_id, status)
+
+
+def read_frames(conn):
+    buffer = b""
+    while True:
+        data = conn.recv(1024)
+        if not data:
+            return
+        buffer += data
+        while len(buffer) >= 5:
+            command, msg_id, length = struct.unpack(">BHH", buffer[:5])
+            body_length = 0 if command == CMD_RESPONSE else length
+            if len(buffer) < 5 + body_length:
+                break
+            yield command, msg_id, length, buffer[5:5 + body_length]
+            buffer = buffer[5 + body_length:]
+
+
+class Node:
+    def __init__(self, token):
+        self.token = token
+        self.pins = {2: b"0", 3: b"1", 4: b"55"}
+        self.push_id = 0
+        self.lock = threading.Lock()
+
+    def push(self, conn, pin, value):
+        with self.lock:
+            self.push_id = self.push_id % 0xFFFF + 1
+            conn.sendall(frame(CMD_HARDWARE, self.push_id, b"vw\0" + str(pin).encode() + b"\0" + value))
+
+    def serve(self, conn, address):
+        logged_in = False
+        for command, msg_id, length, body in read_frames(conn):
+            if command == CMD_HW_LOGIN:
+                token = body.decode(errors="replace")
+                if token != self.token:
+                    print(f"node: rejected token from {address}", flush=True)
+                    conn.sendall(response(msg_id, STATUS_INVALID_TOKEN))
+                    return
+                logged_in = True
+                print(f"node: login from {address}", flush=True)
+                conn.sendall(response(msg_id, STATUS_SUCCESS))
+            elif not logged_in:
+                return
+            elif command == CMD_PING:
+                conn.sendall(response(msg_id, STATUS_SUCCESS))
+            elif command == CMD_HARDWARE_SYNC:
+                fields = body.split(b"\0")
+                print(f"node: sync {fields}", flush=True)
+                for pin in fields[1:]:
+                    value = self.pins.get(int(pin))
+                    if value is not None:
+                        self.push(conn, int(pin), value)
+            elif command == CMD_HARDWARE:
+                fields = body.split(b"\0")
+                if len(fields) >= 3 and fields[0] == b"vw":
+                    pin, value = int(fields[1]), fields[2]
+                    print(f"node: V{pin} = {value.decode()}", flush=True)
+                    self.pins[pin] = value
+                    self.push(conn, ECHO_PIN, str(pin).encode() + b":" + value)
+            elif command == CMD_INTERNAL:
+                pass
+
+
+def serve_entry(conn, address, node_port):
+    for command, msg_id, length, body in read_frames(conn):
+        if command == CMD_HW_LOGIN:
+            print(f"entry: redirecting {address} to port {node_port}", flush=True)
+            conn.sendall(frame(CMD_REDIRECT, msg_id, b"127.0.0.1\0" + str(node_port).encode()))
+
+
+def listen(port, handler):
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("127.0.0.1", port))
+    server.listen()
+
+    def accept_loop():
+        while True:
+            conn, address = server.accept()
+
+            def run(conn=conn, address=address):
+                with conn:
+                    try:
+                        handler(conn, address)
+                    except OSError:
+                        pass
+
+            threading.Thread(target=run, daemon=True).start()
+
+    return threading.Thread(target=accept_loop, daemon=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--entry-port", type=int, default=18080)
+    parser.add_argument("--node-port", type=int, default=18081)
+    parser.add_argument("--token", default="host-test-token")
+    args = parser.parse_args()
+
+    node = Node(args.token)
+    threads = [
+        listen(args.entry_port, lambda conn, address: serve_entry(conn, address, args.node_port)),
+        listen(args.node_port, node.serve),
+    ]
+    for thread in threads:
+        thread.start()
+    print(f"ready: entry {args.entry_port}, node {args.node_port}", flush=True)
+    threads[0].join()
+
+
+if __name__ == "__main__":
+    main()
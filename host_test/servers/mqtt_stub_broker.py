@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Minimal MQTT 3.1.1 broker, a stand-in for mosquitto where none is installed.
+
+Enough for the transport test: CONNECT/CONNACK, SUBSCRIBE with + and #
+filters, PUBLISH at QoS 0 and 1 (PUBACK to the publisher, forwarding to
+every matching subscriber), PINGREQ and DISCONNECT. No retained messages,
+no persistent sessions. --reject-password refuses clients logging in with
+that password (return code 5, not authorized), the way Blynk refuses an
+unknown auth token.
+"""
+
+import argparse
+import socket
+import struct
+import threading
+
+CONNECT, CONNACK, PUBLISH, PUBACK, SUBSCRIBE, SUBACK, PINGREQ, PINGRESP, DISCONNECT = 1, 2, 3, 4, 8, 9, 12, 13, 14
+
+
+def encode_length(length):
+    encoded = bytearray()
+    while True:
+        digit = length % 128
+        length //= 128
+        encoded.append(digit | 0x80 if length else digit)
+        if not length:
+            return bytes(encoded)
+
+
+def packet(first_byte, body=b""):
+    return bytes([first_byte]) + encode_length(len(body)) + body
+
+
+def read_exact(conn, length):
+    data = b""
+    while len(data) < length:
+        chunk = conn.recv(length - len(data))
+        if not chunk:
+            raise ConnectionError("closed")
+        data += chunk
+    return data
+
+
+def read_packet(conn):
+    first = read_exact(conn, 1)[0]
+    length, multiplier = 0, 1
+    while True:
+        digit = read_exact(conn, 1)[0]
+        length += (digit & 0x7F) * multiplier
+        multiplier *= 128
+        if not digit & 0x80:
+            break
+    return first >> 4, first & 0x0F, read_exact(conn, length)
+
+
+def read_string(body, offset):
+    length = struct.unpack(">H", body[offset:offset + 2])[0]
+    return body[offset + 2:offset + 2 + length], offset + 2 + length
+
+
+def matches(topic_filter, topic):
+    filter_levels = topic_filter.split("/")
+    topic_levels = topic.split("/")
+    for index, level in enumerate(filter_levels):
+        if level == "#":
+            return True
+        if index >= len(topic_levels) or (level != "+" and level != topic_levels[index]):
+            return False
+    return len(filter_levels) == len(topic_levels)
+
+
+class Session:
+    def __init__(self, conn):
+        self.conn = conn
+        self.subscriptions = {}
+        self.next_id = 0
+        self.lock = threading.Lock()
+
+    def send(self, data):
+        with self.lock:
+            self.conn.sendall(data)
+
+    def deliver(self, topic, payload, qos):
+        body = struct.pack(">H", len(topic)) + topic
+        if qos:
+            with self.lock:
+                self.next_id = self.next_id % 0xFFFF + 1
+                body += struct.pack(">H", self.next_id)
+        self.send(packet((PUBLISH << 4) | (qos << 1), body + payload))
+
+
+class Broker:
+    def __init__(self, reject_password):
+        self.reject_password = reject_password.encode() if reject_password else None
+        self.sessions = []
+        self.lock = threading.Lock()
+
+    def route(self, topic, payload, qos):
+        with self.lock:
+            sessions = list(self.sessions)
+        for session in sessions:
+            granted = [q for f, q in session.subscriptions.items() if matches(f, topic.decode(errors="replace"))]
+            if granted:
+                try:
+                    session.deliver(topic, payload, min(qos, max(granted)))
+                except OSError:
+                    pass
+
+    def serve(self, conn, address):
+        session = Session(conn)
+        try:
+            kind, flags, body = read_packet(conn)
+            if kind != CONNECT:
+                return
+            _, offset = read_string(body, 0)
+            connect_flags = body[offset + 1]
+            offset += 4
+            client_id, offset = read_string(body, offset)
+            password = None
+            if connect_flags & 0x80:
+                _, offset = read_string(body, offset)
+            if connect_flags & 0x40:
+                password, offset = read_string(body, offset)
+            if self.reject_password is not None and password == self.reject_password:
+                print(f"refused {client_id.decode()}", flush=True)
+                session.send(packet(CONNACK << 4, b"\x00\x05"))
+                return
+            session.send(packet(CONNACK << 4, b"\x00\x00"))
+            print(f"connected {client_id.decode()}", flush=True)
+            with self.lock:
+                self.sessions.append(session)
+
+            while True:
+                kind, flags, body = read_packet(conn)
+                if kind == PUBLISH:
+                    qos = (flags >> 1) & 0x03
+                    topic, offset = read_string(body, 0)
+                    if qos:
+                        msg_id = body[offset:offset + 2]
+                        offset += 2
+                    self.route(topic, body[offset:], min(qos, 1))
+                    if qos:
+                        session.send(packet(PUBACK << 4, msg_id))
+                elif kind == SUBSCRIBE:
+                    msg_id, offset, granted = body[:2], 2, b""
+                    while offset < len(body):
+                        topic_filter, offset = read_string(body, offset)
+                        qos = min(body[offset], 1)
+                        offset += 1
+                        session.subscriptions[topic_filter.decode()] = qos
+                        granted += bytes([qos])
+                    session.send(packet(SUBACK << 4, msg_id + granted))
+                elif kind == PINGREQ:
+                    session.send(packet(PINGRESP << 4))
+                elif kind == DISCONNECT:
+                    return
+        except (ConnectionError, OSError):
+            pass
+        finally:
+            with self.lock:
+                if session in self.sessions:
+                    self.sessions.remove(session)
+            conn.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--port", type=int, default=11883)
+    parser.add_argument("--reject-password")
+    args = parser.parse_args()
+
+    broker = Broker(args.reject_password)
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("127.0.0.1", args.port))
+    server.listen()
+    print(f"ready: mqtt://127.0.0.1:{args.port}", flush=True)
+    while True:
+        conn, address = server.accept()
+        threading.Thread(target=broker.serve, args=(conn, address), daemon=True).start()
+
+
+if __name__ == "__main__":
+    main()
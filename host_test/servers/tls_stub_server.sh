@@ -0,0 +1,40 @@
+#!/bin/sh
+# Stand-in HTTPS server for checking TLS session resumption.
+#   tls_stub_server.sh <port> <dir> [host name]
+# Writes a self-signed certificate for the host name (default blynk.local,
+# plus 127.0.0.1) to <dir>/tls_stub_cert.pem; that PEM is what
+# setServerCertificate() / BLYNK_CA_CERT_PEM must trust. Serves TLS 1.2 with
+# session tickets through openssl s_server -www: every GET gets a status page
+# and the connection is closed, so each request reconnects, and the page says
+# "New" or "Reused" for its session. blynk_https_session_test checks those
+# against BlynkHttpSession's session offers; a device pointed at
+# https://<host name>:<port> can be compared the same way through its TLS
+# log line.
+set -eu
+
+port=$1
+dir=$2
+name=${3:-blynk.local}
+
+san="DNS:$name,IP:127.0.0.1"
+case "$name" in
+    *[!0-9.]*) ;;
+    *) san="IP:$name,IP:127.0.0.1" ;;
+esac
+
+mkdir -p "$dir"
+openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 3650 \
+    -subj "/CN=$name" -addext "subjectAltName=$san" \
+    -keyout "$dir/tls_stub_key.pem" -out "$dir/tls_stub_cert.pem" 2> /dev/null
+
+openssl s_server -accept "$port" -cert "$dir/tls_stub_cert.pem" -key "$dir/tls_stub_key.pem" \
+    -tls1_2 -www > "$dir/tls_stub_server.out" 2>&1 &
+server=$!
+trap 'kill $server 2> /dev/null' EXIT INT TERM
+
+for _ in 1 2 3 4 5 6 7 8 9 10; do
+    grep -q ACCEPT "$dir/tls_stub_server.out" && break
+    sleep 0.2
+done
+echo "ready: https://$name:$port, certificate $dir/tls_stub_cert.pem"
+wait $server
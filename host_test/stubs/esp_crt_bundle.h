@@ -0,0 +1,13 @@
+//esp_crt_bundle.h (host stub): the host shim verifies against the system
+// CA store when no certificate is given
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+esp_err_t esp_crt_bundle_attach(void* conf);
+#ifdef __cplusplus
+}
+#endif
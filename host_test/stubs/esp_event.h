@@ -0,0 +1,8 @@
+//esp_event.h (host stub)
+#pragma once
+
+#include <stdint.h>
+
+typedef const char* esp_event_base_t;
+typedef void (*esp_event_handler_t)(void* event_handler_arg, esp_event_base_t event_base,
+                                    int32_t event_id, void* event_data);
@@ -0,0 +1,72 @@
+//esp_http_client.h (host stub): the subset of the esp_http_client API the
+// firmware uses, implemented by esp_http_client_openssl.cpp over POSIX
+// sockets and OpenSSL (HTTP/1.1 keep-alive, https:// with session reuse)
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ESP_ERR_HTTP_BASE       0x7000
+#define ESP_ERR_HTTP_CONNECT    (ESP_ERR_HTTP_BASE + 2)
+#define ESP_ERR_HTTP_EAGAIN     (ESP_ERR_HTTP_BASE + 7)
+
+typedef struct esp_http_client* esp_http_client_handle_t;
+
+typedef enum {
+    HTTP_EVENT_ERROR = 0,
+    HTTP_EVENT_ON_CONNECTED,
+    HTTP_EVENT_HEADERS_SENT,
+    HTTP_EVENT_ON_HEADER,
+    HTTP_EVENT_ON_DATA,
+    HTTP_EVENT_ON_FINISH,
+    HTTP_EVENT_DISCONNECTED,
+    HTTP_EVENT_REDIRECT
+} esp_http_client_event_id_t;
+
+typedef struct {
+    esp_http_client_event_id_t event_id;
+    esp_http_client_handle_t client;
+    void* data;
+    int data_len;
+    void* user_data;
+    char* header_key;
+    char* header_value;
+} esp_http_client_event_t;
+
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t* evt);
+
+typedef enum {
+    HTTP_METHOD_GET = 0,
+    HTTP_METHOD_POST
+} esp_http_client_method_t;
+
+typedef struct {
+    const char* url;
+    const char* cert_pem;
+    const char* common_name;
+    esp_http_client_method_t method;
+    int timeout_ms;
+    http_event_handle_cb event_handler;
+    void* user_data;
+    bool keep_alive_enable;
+    bool save_client_session;
+    esp_err_t (*crt_bundle_attach)(void* conf);
+} esp_http_client_config_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t* config);
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client);
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char* url);
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method);
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char* key, const char* value);
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char* key);
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char* data, int len);
+int esp_http_client_get_status_code(esp_http_client_handle_t client);
+esp_err_t esp_http_client_close(esp_http_client_handle_t client);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,394 @@
+//esp_http_client_openssl.cpp: esp_http_client API over POSIX sockets and
+// OpenSSL for the host tests. Like esp_http_client it keeps the connection
+// open between requests unless the server closes it (HTTP/1.0 or
+// "Connection: close"), reconnects on the next perform, and with
+// save_client_session offers the last TLS session again when it does.
+// Responses need a Content-Length or end with the connection; chunked
+// bodies are not supported.
+#include "esp_http_client.h"
+#include "esp_crt_bundle.h"
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct esp_http_client {
+    esp_http_client_config_t config;
+    std::string commonName;
+    std::string scheme;
+    std::string host;
+    std::string port;
+    std::string pathAndQuery;
+    esp_http_client_method_t method;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string postField;
+    int statusCode = 0;
+
+    int sock = -1;
+    SSL_CTX* sslContext = nullptr;
+    SSL* ssl = nullptr;
+    SSL_SESSION* savedSession = nullptr;
+};
+
+esp_err_t esp_crt_bundle_attach(void* conf) {
+    return ESP_OK;
+}
+
+static void dispatch(esp_http_client* client, esp_http_client_event_id_t id, const void* data = nullptr, int length = 0,
+                     char* key = nullptr, char* value = nullptr) {
+    if (client->config.event_handler == nullptr) {
+        return;
+    }
+    esp_http_client_event_t event = {};
+    event.event_id = id;
+    event.client = client;
+    event.data = const_cast<void*>(data);
+    event.data_len = length;
+    event.user_data = client->config.user_data;
+    event.header_key = key;
+    event.header_value = value;
+    client->config.event_handler(&event);
+}
+
+static void closeConnection(esp_http_client* client) {
+    if (client->ssl) {
+        SSL_shutdown(client->ssl);
+        SSL_free(client->ssl);
+        client->ssl = nullptr;
+    }
+    if (client->sock >= 0) {
+        close(client->sock);
+        client->sock = -1;
+    }
+}
+
+// True while the kept-alive connection is still usable: not readable, or
+// readable with data (a readable socket with nothing to read is closed)
+static bool connectionAlive(esp_http_client* client) {
+    if (client->sock < 0) {
+        return false;
+    }
+    pollfd pending = { client->sock, POLLIN, 0 };
+    if (poll(&pending, 1, 0) == 0) {
+        return true;
+    }
+    char byte;
+    return recv(client->sock, &byte, 1, MSG_PEEK | MSG_DONTWAIT) > 0;
+}
+
+static bool isTls(const esp_http_client* client) {
+    return client->scheme == "https";
+}
+
+static esp_err_t openConnection(esp_http_client* client) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(client->host.c_str(), client->port.c_str(), &hints, &result) != 0 || result == nullptr) {
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    client->sock = socket(result->ai_family, result->ai_socktype, 0);
+    if (client->sock >= 0 && connect(client->sock, result->ai_addr, result->ai_addrlen) != 0) {
+        close(client->sock);
+        client->sock = -1;
+    }
+    freeaddrinfo(result);
+    if (client->sock < 0) {
+        return ESP_ERR_HTTP_CONNECT;
+    }
+
+    int noDelay = 1;
+    setsockopt(client->sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    int timeoutMs = client->config.timeout_ms > 0 ? client->config.timeout_ms : 5000;
+    timeval timeout = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+    setsockopt(client->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client->sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (!isTls(client)) {
+        return ESP_OK;
+    }
+
+    // The certificate must name common_name, or the URL host without one
+    const std::string& name = client->commonName.empty() ? client->host : client->commonName;
+    client->ssl = SSL_new(client->sslContext);
+    SSL_set_fd(client->ssl, client->sock);
+    SSL_set_tlsext_host_name(client->ssl, name.c_str());
+    SSL_set1_host(client->ssl, name.c_str());
+    if (client->savedSession) {
+        SSL_set_session(client->ssl, client->savedSession);
+    }
+    if (SSL_connect(client->ssl) != 1) {
+        fprintf(stderr, "http stub: TLS handshake with %s failed: %s\n", name.c_str(),
+                ERR_reason_error_string(ERR_get_error()));
+        closeConnection(client);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+
+    if (client->config.save_client_session) {
+        if (client->savedSession) {
+            SSL_SESSION_free(client->savedSession);
+        }
+        client->savedSession = SSL_get1_session(client->ssl);
+    }
+    return ESP_OK;
+}
+
+static bool sendAll(esp_http_client* client, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int written = client->ssl ? SSL_write(client->ssl, data.data() + sent, static_cast<int>(data.size() - sent))
+                                  : static_cast<int>(send(client->sock, data.data() + sent, data.size() - sent, MSG_NOSIGNAL));
+        if (written <= 0) {
+            return false;
+        }
+        sent += written;
+    }
+    return true;
+}
+
+// Reads up to `size` bytes; 0 at the end of the connection, -1 on error
+static int receive(esp_http_client* client, char* buffer, int size) {
+    if (client->ssl) {
+        int count = SSL_read(client->ssl, buffer, size);
+        if (count > 0) {
+            return count;
+        }
+        int error = SSL_get_error(client->ssl, count);
+        return error == SSL_ERROR_ZERO_RETURN || error == SSL_ERROR_SYSCALL ? 0 : -1;
+    }
+    return static_cast<int>(recv(client->sock, buffer, size, 0));
+}
+
+static esp_err_t readResponse(esp_http_client* client, bool& keepAlive) {
+    std::string received;
+    char buffer[2048];
+    size_t headerEnd;
+    while ((headerEnd = received.find("\r\n\r\n")) == std::string::npos) {
+        int count = receive(client, buffer, sizeof(buffer));
+        if (count <= 0) {
+            return ESP_FAIL;
+        }
+        received.append(buffer, count);
+    }
+
+    // Status line, then one ON_HEADER per header
+    size_t lineEnd = received.find("\r\n");
+    std::string statusLine = received.substr(0, lineEnd);
+    if (statusLine.compare(0, 5, "HTTP/") != 0 || statusLine.size() < 12) {
+        return ESP_FAIL;
+    }
+    client->statusCode = atoi(statusLine.c_str() + 9);
+    keepAlive = statusLine.compare(0, 8, "HTTP/1.1") == 0;
+
+    long contentLength = -1;
+    size_t lineStart = lineEnd + 2;
+    while (lineStart < headerEnd) {
+        lineEnd = received.find("\r\n", lineStart);
+        std::string line = received.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 2;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, colon);
+        size_t valueStart = line.find_first_not_of(' ', colon + 1);
+        std::string value = valueStart == std::string::npos ? std::string() : line.substr(valueStart);
+        if (strcasecmp(key.c_str(), "Content-Length") == 0) {
+            contentLength = atol(value.c_str());
+        } else if (strcasecmp(key.c_str(), "Connection") == 0) {
+            keepAlive = strcasecmp(value.c_str(), "close") != 0;
+        } else if (strcasecmp(key.c_str(), "Transfer-Encoding") == 0) {
+            fprintf(stderr, "http stub: Transfer-Encoding %s not supported\n", value.c_str());
+            return ESP_FAIL;
+        }
+        dispatch(client, HTTP_EVENT_ON_HEADER, nullptr, 0, key.data(), value.data());
+    }
+    if (contentLength < 0) {
+        keepAlive = false;  // the body ends with the connection
+    }
+
+    // Body: what came with the headers, then the rest
+    long bodyReceived = 0;
+    std::string rest = received.substr(headerEnd + 4);
+    if (!rest.empty()) {
+        dispatch(client, HTTP_EVENT_ON_DATA, rest.data(), static_cast<int>(rest.size()));
+        bodyReceived = static_cast<long>(rest.size());
+    }
+    while (contentLength < 0 || bodyReceived < contentLength) {
+        int count = receive(client, buffer, sizeof(buffer));
+        if (count == 0 && contentLength < 0) {
+            break;
+        }
+        if (count <= 0) {
+            return ESP_FAIL;
+        }
+        dispatch(client, HTTP_EVENT_ON_DATA, buffer, count);
+        bodyReceived += count;
+    }
+    dispatch(client, HTTP_EVENT_ON_FINISH);
+    return ESP_OK;
+}
+
+static void parseUrl(esp_http_client* client, const char* url) {
+    std::string text = url;
+    size_t schemeEnd = text.find("://");
+    client->scheme = schemeEnd == std::string::npos ? "http" : text.substr(0, schemeEnd);
+    size_t hostStart = schemeEnd == std::string::npos ? 0 : schemeEnd + 3;
+    size_t pathStart = text.find('/', hostStart);
+    std::string authority = text.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+    client->pathAndQuery = pathStart == std::string::npos ? "/" : text.substr(pathStart);
+
+    size_t colon = authority.find(':');
+    client->host = authority.substr(0, colon);
+    client->port = colon != std::string::npos ? authority.substr(colon + 1) : (isTls(client) ? "443" : "80");
+}
+
+extern "C" esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t* config) {
+    if (config == nullptr || config->url == nullptr) {
+        return nullptr;
+    }
+
+    esp_http_client* client = new esp_http_client();
+    client->config = *config;
+    client->commonName = config->common_name ? config->common_name : "";
+    client->method = config->method;
+    parseUrl(client, config->url);
+
+    client->sslContext = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_verify(client->sslContext, SSL_VERIFY_PEER, nullptr);
+    SSL_CTX_set_session_cache_mode(client->sslContext, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    if (config->cert_pem) {
+        BIO* pem = BIO_new_mem_buf(config->cert_pem, -1);
+        X509* certificate = PEM_read_bio_X509(pem, nullptr, nullptr, nullptr);
+        BIO_free(pem);
+        if (certificate == nullptr) {
+            fprintf(stderr, "http stub: cert_pem is not a PEM certificate\n");
+        } else {
+            X509_STORE_add_cert(SSL_CTX_get_cert_store(client->sslContext), certificate);
+            X509_free(certificate);
+        }
+    } else {
+        SSL_CTX_set_default_verify_paths(client->sslContext);
+    }
+    return client;
+}
+
+extern "C" esp_err_t esp_http_client_perform(esp_http_client_handle_t client) {
+    if (client == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!connectionAlive(client)) {
+        closeConnection(client);
+        esp_err_t err = openConnection(client);
+        if (err != ESP_OK) {
+            dispatch(client, HTTP_EVENT_ERROR);
+            return err;
+        }
+        dispatch(client, HTTP_EVENT_ON_CONNECTED);
+    }
+
+    bool post = client->method == HTTP_METHOD_POST;
+    std::string request = std::string(post ? "POST " : "GET ") + client->pathAndQuery + " HTTP/1.1\r\n";
+    bool hostSet = false;
+    for (const auto& header : client->headers) {
+        request += header.first + ": " + header.second + "\r\n";
+        hostSet = hostSet || strcasecmp(header.first.c_str(), "Host") == 0;
+    }
+    if (!hostSet) {
+        request += "Host: " + client->host + "\r\n";
+    }
+    if (post) {
+        request += "Content-Length: " + std::to_string(client->postField.size()) + "\r\n";
+    }
+    request += client->config.keep_alive_enable ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    if (post) {
+        request += client->postField;
+    }
+
+    bool keepAlive = false;
+    if (!sendAll(client, request)) {
+        closeConnection(client);
+        return ESP_FAIL;
+    }
+    dispatch(client, HTTP_EVENT_HEADERS_SENT);
+
+    esp_err_t err = readResponse(client, keepAlive);
+    if (err != ESP_OK || !keepAlive || !client->config.keep_alive_enable) {
+        closeConnection(client);
+        dispatch(client, HTTP_EVENT_DISCONNECTED);
+    }
+    return err;
+}
+
+extern "C" esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char* url) {
+    std::string previousHost = client->host;
+    std::string previousPort = client->port;
+    std::string previousScheme = client->scheme;
+    parseUrl(client, url);
+    // Another server needs another connection
+    if (client->host != previousHost || client->port != previousPort || client->scheme != previousScheme) {
+        closeConnection(client);
+    }
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method) {
+    client->method = method;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char* key, const char* value) {
+    esp_http_client_delete_header(client, key);
+    client->headers.emplace_back(key, value);
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char* key) {
+    for (auto it = client->headers.begin(); it != client->headers.end(); ++it) {
+        if (strcasecmp(it->first.c_str(), key) == 0) {
+            client->headers.erase(it);
+            return ESP_OK;
+        }
+    }
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char* data, int len) {
+    client->postField.assign(data ? data : "", data ? len : 0);
+    return ESP_OK;
+}
+
+extern "C" int esp_http_client_get_status_code(esp_http_client_handle_t client) {
+    return client->statusCode;
+}
+
+extern "C" esp_err_t esp_http_client_close(esp_http_client_handle_t client) {
+    closeConnection(client);
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) {
+    if (client == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    closeConnection(client);
+    if (client->savedSession) {
+        SSL_SESSION_free(client->savedSession);
+    }
+    SSL_CTX_free(client->sslContext);
+    delete client;
+    return ESP_OK;
+}
@@ -0,0 +1,79 @@
+//idf_posix.cpp: the few IDF and FreeRTOS calls the transports use, on POSIX
+#include "esp_err.h"
+#include "esp_http_client.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <pthread.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+static const auto startTime = std::chrono::steady_clock::now();
+
+extern "C" const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_HTTP_CONNECT: return "ESP_ERR_HTTP_CONNECT";
+        case ESP_ERR_HTTP_EAGAIN: return "ESP_ERR_HTTP_EAGAIN";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+extern "C" int64_t esp_timer_get_time(void) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+extern "C" BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stackDepth, void* parameters,
+                                  UBaseType_t priority, TaskHandle_t* createdTask) {
+    std::thread thread(task, parameters);
+    if (createdTask) {
+        *createdTask = reinterpret_cast<TaskHandle_t>(thread.native_handle());
+    }
+    thread.detach();
+    return pdPASS;
+}
+
+extern "C" void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr) {
+        pthread_exit(nullptr);
+    }
+}
+
+extern "C" void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+extern "C" TickType_t xTaskGetTickCount(void) {
+    return static_cast<TickType_t>(esp_timer_get_time() / 1000);
+}
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return new std::timed_mutex();
+}
+
+extern "C" BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    std::timed_mutex* mutex = static_cast<std::timed_mutex*>(semaphore);
+    if (ticks == portMAX_DELAY) {
+        mutex->lock();
+        return pdTRUE;
+    }
+    return mutex->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+extern "C" BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    static_cast<std::timed_mutex*>(semaphore)->unlock();
+    return pdTRUE;
+}
+
+extern "C" void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete static_cast<std::timed_mutex*>(semaphore);
+}
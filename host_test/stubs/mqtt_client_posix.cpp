@@ -0,0 +1,447 @@
+//mqtt_client_posix.cpp: esp-mqtt client API over POSIX sockets for the host tests.
+// One thread per client connects, reconnects and dispatches events, like the
+// esp-mqtt task; publish and subscribe send from the caller's thread.
+#include "mqtt_client.h"
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum PacketType : uint8_t {
+    PACKET_CONNECT = 1,
+    PACKET_CONNACK = 2,
+    PACKET_PUBLISH = 3,
+    PACKET_PUBACK = 4,
+    PACKET_SUBSCRIBE = 8,
+    PACKET_SUBACK = 9,
+    PACKET_PINGREQ = 12,
+    PACKET_PINGRESP = 13,
+    PACKET_DISCONNECT = 14
+};
+
+static std::atomic<int> publishReturnDelayMs(0);
+
+struct esp_mqtt_client {
+    std::string host;
+    std::string port;
+    std::string username;
+    std::string password;
+    std::string clientId;
+    int keepaliveS;
+    int reconnectMs;
+    int timeoutMs;
+
+    esp_event_handler_t handler = nullptr;
+    void* handlerArgs = nullptr;
+
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> connected{ false };
+    std::mutex sendMutex;
+    int sock = -1;  // guarded by sendMutex
+    uint16_t packetId = 0;
+    std::chrono::steady_clock::time_point lastSend;
+};
+
+static void appendLength(std::vector<uint8_t>& packet, size_t length) {
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        packet.push_back(length > 0 ? digit | 0x80 : digit);
+    } while (length > 0);
+}
+
+static void appendString(std::vector<uint8_t>& body, const std::string& text) {
+    body.push_back(static_cast<uint8_t>(text.size() >> 8));
+    body.push_back(static_cast<uint8_t>(text.size() & 0xFF));
+    body.insert(body.end(), text.begin(), text.end());
+}
+
+static std::vector<uint8_t> makePacket(uint8_t firstByte, const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> packet{ firstByte };
+    appendLength(packet, body.size());
+    packet.insert(packet.end(), body.begin(), body.end());
+    return packet;
+}
+
+static bool sendPacket(esp_mqtt_client* client, const std::vector<uint8_t>& packet) {
+    std::lock_guard<std::mutex> lock(client->sendMutex);
+    if (client->sock < 0) {
+        return false;
+    }
+    size_t sent = 0;
+    while (sent < packet.size()) {
+        ssize_t written = send(client->sock, packet.data() + sent, packet.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            shutdown(client->sock, SHUT_RDWR);
+            return false;
+        }
+        sent += written;
+    }
+    client->lastSend = std::chrono::steady_clock::now();
+    return true;
+}
+
+static uint16_t nextPacketId(esp_mqtt_client* client) {
+    std::lock_guard<std::mutex> lock(client->sendMutex);
+    if (++client->packetId == 0) {
+        client->packetId = 1;
+    }
+    return client->packetId;
+}
+
+static void postEvent(esp_mqtt_client* client, esp_mqtt_event_t& event) {
+    event.client = client;
+    if (client->handler) {
+        client->handler(client->handlerArgs, "MQTT_EVENTS", event.event_id, &event);
+    }
+}
+
+static void postSimpleEvent(esp_mqtt_client* client, esp_mqtt_event_id_t id, int msgId = 0) {
+    esp_mqtt_event_t event = {};
+    event.event_id = id;
+    event.msg_id = msgId;
+    postEvent(client, event);
+}
+
+static bool readExact(int fd, uint8_t* data, size_t length) {
+    size_t received = 0;
+    while (received < length) {
+        ssize_t count = recv(fd, data + received, length - received, 0);
+        if (count <= 0) {
+            return false;
+        }
+        received += count;
+    }
+    return true;
+}
+
+// Waits up to waitMs for a packet to start; false on timeout (empty type) or error
+static bool readPacket(int fd, int waitMs, uint8_t& type, uint8_t& flags, std::vector<uint8_t>& body, bool& failed) {
+    type = 0;
+    failed = false;
+    pollfd pending = { fd, POLLIN, 0 };
+    int ready = poll(&pending, 1, waitMs);
+    if (ready == 0) {
+        return false;
+    }
+
+    uint8_t firstByte;
+    if (ready < 0 || !readExact(fd, &firstByte, 1)) {
+        failed = true;
+        return false;
+    }
+
+    size_t length = 0;
+    size_t multiplier = 1;
+    uint8_t digit;
+    do {
+        if (!readExact(fd, &digit, 1) || multiplier > 128 * 128 * 128) {
+            failed = true;
+            return false;
+        }
+        length += (digit & 0x7F) * multiplier;
+        multiplier *= 128;
+    } while (digit & 0x80);
+
+    body.resize(length);
+    if (length > 0 && !readExact(fd, body.data(), length)) {
+        failed = true;
+        return false;
+    }
+    type = firstByte >> 4;
+    flags = firstByte & 0x0F;
+    return true;
+}
+
+static int openSocket(esp_mqtt_client* client) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(client->host.c_str(), client->port.c_str(), &hints, &result) != 0 || result == nullptr) {
+        return -1;
+    }
+    int fd = socket(result->ai_family, result->ai_socktype, 0);
+    if (fd >= 0 && connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    if (fd >= 0) {
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        timeval timeout = { client->timeoutMs / 1000, (client->timeoutMs % 1000) * 1000 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    return fd;
+}
+
+// Sends CONNECT and waits for CONNACK; returns the broker's return code or -1
+static int login(esp_mqtt_client* client, int fd) {
+    std::vector<uint8_t> body;
+    appendString(body, "MQTT");
+    body.push_back(4);  // protocol level 3.1.1
+    uint8_t connectFlags = 0x02;  // clean session
+    if (!client->username.empty()) {
+        connectFlags |= 0x80;
+    }
+    if (!client->password.empty()) {
+        connectFlags |= 0x40;
+    }
+    body.push_back(connectFlags);
+    body.push_back(static_cast<uint8_t>(client->keepaliveS >> 8));
+    body.push_back(static_cast<uint8_t>(client->keepaliveS & 0xFF));
+    appendString(body, client->clientId);
+    if (!client->username.empty()) {
+        appendString(body, client->username);
+    }
+    if (!client->password.empty()) {
+        appendString(body, client->password);
+    }
+    if (!sendPacket(client, makePacket(PACKET_CONNECT << 4, body))) {
+        return -1;
+    }
+
+    uint8_t type, flags;
+    std::vector<uint8_t> answer;
+    bool failed;
+    if (!readPacket(fd, client->timeoutMs, type, flags, answer, failed) || type != PACKET_CONNACK || answer.size() < 2) {
+        return -1;
+    }
+    return answer[1];
+}
+
+static bool handlePacket(esp_mqtt_client* client, uint8_t type, uint8_t flags, std::vector<uint8_t>& body) {
+    switch (type) {
+        case PACKET_PUBLISH: {
+            if (body.size() < 2) {
+                return false;
+            }
+            size_t topicLength = (body[0] << 8) | body[1];
+            int qos = (flags >> 1) & 0x03;
+            size_t offset = 2 + topicLength + (qos > 0 ? 2 : 0);
+            if (offset > body.size()) {
+                return false;
+            }
+            int msgId = qos > 0 ? (body[2 + topicLength] << 8) | body[3 + topicLength] : 0;
+
+            esp_mqtt_event_t event = {};
+            event.event_id = MQTT_EVENT_DATA;
+            event.topic = reinterpret_cast<char*>(body.data() + 2);
+            event.topic_len = static_cast<int>(topicLength);
+            event.data = reinterpret_cast<char*>(body.data() + offset);
+            event.data_len = static_cast<int>(body.size() - offset);
+            event.total_data_len = event.data_len;
+            event.msg_id = msgId;
+            event.qos = qos;
+            postEvent(client, event);
+
+            if (qos == 1) {
+                return sendPacket(client, makePacket(PACKET_PUBACK << 4, { body[2 + topicLength], body[3 + topicLength] }));
+            }
+            return true;
+        }
+
+        case PACKET_PUBACK:
+            if (body.size() >= 2) {
+                postSimpleEvent(client, MQTT_EVENT_PUBLISHED, (body[0] << 8) | body[1]);
+            }
+            return true;
+
+        case PACKET_SUBACK:
+            if (body.size() >= 2) {
+                postSimpleEvent(client, MQTT_EVENT_SUBSCRIBED, (body[0] << 8) | body[1]);
+            }
+            return true;
+
+        case PACKET_PINGRESP:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+static void clientTask(esp_mqtt_client* client) {
+    while (client->running) {
+        int fd = openSocket(client);
+        if (fd >= 0) {
+            {
+                std::lock_guard<std::mutex> lock(client->sendMutex);
+                client->sock = fd;
+            }
+
+            int returnCode = login(client, fd);
+            if (returnCode == 0) {
+                client->connected = true;
+                postSimpleEvent(client, MQTT_EVENT_CONNECTED);
+
+                while (client->running) {
+                    uint8_t type, flags;
+                    std::vector<uint8_t> body;
+                    bool failed;
+                    if (readPacket(fd, 100, type, flags, body, failed)) {
+                        if (!handlePacket(client, type, flags, body)) {
+                            break;
+                        }
+                    } else if (failed) {
+                        break;
+                    }
+
+                    auto idle = std::chrono::steady_clock::now() - client->lastSend;
+                    if (idle >= std::chrono::seconds(client->keepaliveS) / 2 && !sendPacket(client, { PACKET_PINGREQ << 4, 0 })) {
+                        break;
+                    }
+                }
+                if (!client->running) {
+                    sendPacket(client, { PACKET_DISCONNECT << 4, 0 });
+                }
+            } else {
+                esp_mqtt_error_codes_t error = {};
+                error.error_type = returnCode > 0 ? MQTT_ERROR_TYPE_CONNECTION_REFUSED : MQTT_ERROR_TYPE_TCP_TRANSPORT;
+                error.connect_return_code = returnCode > 0 ? returnCode : 0;
+                esp_mqtt_event_t event = {};
+                event.event_id = MQTT_EVENT_ERROR;
+                event.error_handle = &error;
+                postEvent(client, event);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(client->sendMutex);
+                close(client->sock);
+                client->sock = -1;
+            }
+            client->connected = false;
+            postSimpleEvent(client, MQTT_EVENT_DISCONNECTED);
+        }
+
+        // Sleep in small steps so stop() does not wait for the whole delay
+        for (int waitedMs = 0; client->running && waitedMs < client->reconnectMs; waitedMs += 50) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+}
+
+extern "C" esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t* config) {
+    if (config == nullptr || config->broker.address.uri == nullptr) {
+        return nullptr;
+    }
+
+    // mqtt://host[:port]
+    std::string uri = config->broker.address.uri;
+    const std::string scheme = "mqtt://";
+    if (uri.compare(0, scheme.size(), scheme) != 0) {
+        fprintf(stderr, "mqtt stub: only mqtt:// URIs are supported, got %s\n", uri.c_str());
+        return nullptr;
+    }
+    std::string address = uri.substr(scheme.size());
+    address = address.substr(0, address.find('/'));
+    size_t colon = address.find(':');
+
+    esp_mqtt_client* client = new esp_mqtt_client();
+    client->host = address.substr(0, colon);
+    client->port = colon == std::string::npos ? "1883" : address.substr(colon + 1);
+    client->username = config->credentials.username ? config->credentials.username : "";
+    client->password = config->credentials.authentication.password ? config->credentials.authentication.password : "";
+    static std::atomic<int> clientCount(0);
+    client->clientId = config->credentials.client_id ? config->credentials.client_id
+                                                     : "host-" + std::to_string(getpid()) + "-" + std::to_string(++clientCount);
+    client->keepaliveS = config->session.keepalive > 0 ? config->session.keepalive : 120;
+    client->reconnectMs = config->network.reconnect_timeout_ms > 0 ? config->network.reconnect_timeout_ms : 10000;
+    client->timeoutMs = config->network.timeout_ms > 0 ? config->network.timeout_ms : 10000;
+    return client;
+}
+
+extern "C" esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event,
+                                                    esp_event_handler_t handler, void* handlerArgs) {
+    if (client == nullptr || event != MQTT_EVENT_ANY) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    client->handler = handler;
+    client->handlerArgs = handlerArgs;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client) {
+    if (client == nullptr || client->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    client->running = true;
+    client->thread = std::thread(clientTask, client);
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client) {
+    if (client == nullptr || !client->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    client->running = false;
+    client->thread.join();
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client) {
+    if (client == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->running) {
+        esp_mqtt_client_stop(client);
+    }
+    delete client;
+    return ESP_OK;
+}
+
+extern "C" int esp_mqtt_client_subscribe_single(esp_mqtt_client_handle_t client, const char* topic, int qos) {
+    if (client == nullptr || !client->connected) {
+        return -1;
+    }
+    uint16_t id = nextPacketId(client);
+    std::vector<uint8_t> body{ static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id & 0xFF) };
+    appendString(body, topic);
+    body.push_back(static_cast<uint8_t>(qos));
+    return sendPacket(client, makePacket((PACKET_SUBSCRIBE << 4) | 0x02, body)) ? id : -1;
+}
+
+extern "C" int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char* topic, const char* data, int len,
+                                       int qos, int retain) {
+    if (client == nullptr || !client->connected) {
+        return -1;
+    }
+    if (len == 0 && data != nullptr) {
+        len = static_cast<int>(strlen(data));
+    }
+
+    uint16_t id = qos > 0 ? nextPacketId(client) : 0;
+    std::vector<uint8_t> body;
+    appendString(body, topic);
+    if (qos > 0) {
+        body.push_back(static_cast<uint8_t>(id >> 8));
+        body.push_back(static_cast<uint8_t>(id & 0xFF));
+    }
+    body.insert(body.end(), data, data + len);
+    uint8_t firstByte = (PACKET_PUBLISH << 4) | ((qos > 0 ? 1 : 0) << 1) | (retain ? 1 : 0);
+    if (!sendPacket(client, makePacket(firstByte, body))) {
+        return -1;
+    }
+
+    int delayMs = publishReturnDelayMs;
+    if (delayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    }
+    return id;
+}
+
+extern "C" void esp_mqtt_host_set_publish_return_delay(int delayMs) {
+    publishReturnDelayMs = delayMs;
+}
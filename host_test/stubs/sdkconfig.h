@@ -0,0 +1,4 @@
+//sdkconfig.h (host stub): options the host shims implement
+#pragma once
+
+#define CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS 1
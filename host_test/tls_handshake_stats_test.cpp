@@ -0,0 +1,84 @@
+//tls_handshake_stats_test.cpp
+#include "TlsHandshakeStats.hpp"
+#include "HostTest.hpp"
+
+// Reconnects with a saved session are judged by their handshake time
+static void testEstimate() {
+    TlsHandshakeStats handshakes;
+
+    // First connection of a client: nothing to resume
+    handshakes.record(1200, false);
+    TlsHandshakeStats::Stats stats = handshakes.getStats();
+    CHECK_EQ(stats.handshakes, 1);
+    CHECK_EQ(stats.sessionOffers, 0);
+    CHECK_EQ(stats.estimatedFull, 1);
+    CHECK_EQ(stats.estimatedResumed, 0);
+    CHECK(!stats.lastEstimatedResumed);
+    CHECK_EQ(stats.averageFullMs, 1200);
+
+    handshakes.record(300, true);
+    stats = handshakes.getStats();
+    CHECK_EQ(stats.sessionOffers, 1);
+    CHECK_EQ(stats.estimatedResumed, 1);
+    CHECK(stats.lastEstimatedResumed);
+    CHECK_EQ(stats.averageResumedMs, 300);
+
+    // Session offered but the server did a full handshake (ticket expired):
+    // estimated full, and the baseline is left alone
+    handshakes.record(900, true);
+    stats = handshakes.getStats();
+    CHECK_EQ(stats.estimatedFull, 2);
+    CHECK(!stats.lastEstimatedResumed);
+    CHECK_EQ(stats.averageFullMs, 1200);
+
+    // Just under half of the average full handshake still counts as resumed
+    handshakes.record(599, true);
+    stats = handshakes.getStats();
+    CHECK_EQ(stats.estimatedResumed, 2);
+    CHECK_EQ(stats.averageResumedMs, 449);
+    handshakes.record(600, true);
+    CHECK_EQ(handshakes.getStats().estimatedFull, 3);
+
+    // No session to offer (new client after a re-route): full for certain,
+    // however fast, and it joins the baseline
+    handshakes.record(100, false);
+    stats = handshakes.getStats();
+    CHECK_EQ(stats.handshakes, 6);
+    CHECK_EQ(stats.sessionOffers, 4);
+    CHECK_EQ(stats.estimatedFull, 4);
+    CHECK_EQ(stats.estimatedResumed, 2);
+    CHECK_EQ(stats.averageFullMs, 650);
+    CHECK_EQ(stats.lastHandshakeMs, 100);
+    CHECK_EQ(stats.maxHandshakeMs, 1200);
+}
+
+// A run of slow offered handshakes does not raise the line
+static void testBaselineOnlyFromFull() {
+    TlsHandshakeStats handshakes;
+    handshakes.record(1000, false);
+    for (int i = 0; i < 10; ++i) {
+        handshakes.record(3000, true);
+    }
+    handshakes.record(450, true);
+    TlsHandshakeStats::Stats stats = handshakes.getStats();
+    CHECK_EQ(stats.averageFullMs, 1000);
+    CHECK_EQ(stats.estimatedFull, 11);
+    CHECK_EQ(stats.estimatedResumed, 1);
+}
+
+// Without a full handshake to compare with, nothing is estimated resumed
+static void testNoBaseline() {
+    TlsHandshakeStats handshakes;
+    handshakes.record(50, true);
+    TlsHandshakeStats::Stats stats = handshakes.getStats();
+    CHECK_EQ(stats.sessionOffers, 1);
+    CHECK_EQ(stats.estimatedFull, 1);
+    CHECK_EQ(stats.estimatedResumed, 0);
+}
+
+int main() {
+    testEstimate();
+    testBaselineOnlyFromFull();
+    testNoBaseline();
+    return hostTestResult("tls_handshake_stats_test");
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Checks that servers/tls_stub_server.sh really resumes sessions: a second
+# connection offering the first one's session must be reported as "Reused".
+#   tls_resumption_check.sh <port> <dir>
+set -u
+port=$1
+dir=$2
+
+request() {
+    printf 'GET /external/api/isHardwareConnected HTTP/1.1\r\nHost: blynk.local\r\n\r\n' \
+        | openssl s_client -connect "127.0.0.1:$port" -servername blynk.local -CAfile "$dir/tls_stub_cert.pem" \
+            -verify_return_error -tls1_2 -ign_eof "$@" 2> /dev/null \
+        | grep -a -m 1 -o '^\(New\|Reused\), TLSv1.2'
+}
+
+first=$(request -sess_out "$dir/tls_session.pem")
+second=$(request -sess_in "$dir/tls_session.pem")
+echo "first connection: $first, second connection: $second"
+if [ "$first" = "New, TLSv1.2" ] && [ "$second" = "Reused, TLSv1.2" ]; then
+    echo "tls_resumption_check: all checks passed"
+    exit 0
+fi
+echo "tls_resumption_check: session was not resumed"
+exit 1
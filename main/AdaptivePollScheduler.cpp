@@ -0,0 +1,75 @@
+//AdaptivePollScheduler.cpp
+#include "AdaptivePollScheduler.hpp"
+
+AdaptivePollScheduler::AdaptivePollScheduler(uint32_t burstIntervalMs, uint32_t initialIntervalMs, uint32_t ceilingIntervalMs,
+                                             uint32_t burstCycles, uint32_t controlCeilingMs)
+    : burstIntervalMs(burstIntervalMs), ceilingIntervalMs(ceilingIntervalMs), burstCycles(burstCycles),
+      controlCeilingMs(controlCeilingMs), currentIntervalMs(initialIntervalMs), pixelIntervalMs(initialIntervalMs),
+      burstRemaining(0), cycles(0), burstEntries(0),
+      history{}, historyHead(0), historyCount(0) {
+    setPolicy(burstIntervalMs, ceilingIntervalMs, burstCycles);
+}
+
+void AdaptivePollScheduler::setPolicy(uint32_t burstIntervalMs, uint32_t ceilingIntervalMs, uint32_t burstCycles) {
+    this->burstIntervalMs = burstIntervalMs > 0 ? burstIntervalMs : 1;
+    this->ceilingIntervalMs = ceilingIntervalMs < this->burstIntervalMs ? this->burstIntervalMs : ceilingIntervalMs;
+    this->burstCycles = burstCycles;
+
+    if (pixelIntervalMs < this->burstIntervalMs) {
+        pixelIntervalMs = this->burstIntervalMs;
+    } else if (pixelIntervalMs > this->ceilingIntervalMs) {
+        pixelIntervalMs = this->ceilingIntervalMs;
+    }
+    currentIntervalMs = pixelIntervalMs < controlCeilingMs ? pixelIntervalMs : controlCeilingMs;
+}
+
+uint32_t AdaptivePollScheduler::nextIntervalMs(bool remoteChanged, bool pixelsPolled) {
+    cycles++;
+
+    if (remoteChanged) {
+        burstEntries++;
+        burstRemaining = burstCycles;
+        pixelIntervalMs = burstIntervalMs;
+    } else if (burstRemaining > 0) {
+        burstRemaining--;
+    } else if (pixelsPolled) {
+        // Exponential backoff while nothing moves
+        pixelIntervalMs = pixelIntervalMs > ceilingIntervalMs / 2 ? ceilingIntervalMs : pixelIntervalMs * 2;
+    }
+    currentIntervalMs = pixelIntervalMs < controlCeilingMs ? pixelIntervalMs : controlCeilingMs;
+
+    history[historyHead] = currentIntervalMs;
+    historyHead = (historyHead + 1) % HISTORY_LENGTH;
+    if (historyCount < HISTORY_LENGTH) {
+        historyCount++;
+    }
+
+    return currentIntervalMs;
+}
+
+uint32_t AdaptivePollScheduler::getCurrentIntervalMs() const {
+    return currentIntervalMs;
+}
+
+uint32_t AdaptivePollScheduler::getPixelIntervalMs() const {
+    return pixelIntervalMs;
+}
+
+AdaptivePollScheduler::Stats AdaptivePollScheduler::getStats() const {
+    Stats stats = {};
+    stats.currentIntervalMs = currentIntervalMs;
+    stats.pixelIntervalMs = pixelIntervalMs;
+    stats.cycles = cycles;
+    stats.burstEntries = burstEntries;
+    stats.historyCount = historyCount;
+
+    uint64_t total = 0;
+    size_t oldest = (historyHead + HISTORY_LENGTH - historyCount) % HISTORY_LENGTH;
+    for (size_t i = 0; i < historyCount; ++i) {
+        stats.history[i] = history[(oldest + i) % HISTORY_LENGTH];
+        total += stats.history[i];
+    }
+    stats.averageIntervalMs = historyCount > 0 ? static_cast<uint32_t>(total / historyCount) : currentIntervalMs;
+
+    return stats;
+}
@@ -0,0 +1,54 @@
+//AdaptivePollScheduler.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Picks the delay before the next poll. A remote change drops the interval to
+// the burst floor for a few cycles (someone is using the app), after that it
+// doubles every stable pixel poll up to the ceiling. That backoff paces the
+// pixel pins only: the control pins are polled every cycle, and a cycle is
+// never longer than the control ceiling.
+class AdaptivePollScheduler {
+public:
+    static constexpr size_t HISTORY_LENGTH = 16;
+
+    struct Stats {
+        uint32_t currentIntervalMs;       // delay before the next poll cycle (control pins)
+        uint32_t averageIntervalMs;       // of the cycle delays in history[]
+        uint32_t pixelIntervalMs;         // backed-off delay between pixel polls
+        uint32_t cycles;
+        uint32_t burstEntries;            // cycles that saw a remote change
+        uint32_t historyCount;            // valid entries in history[]
+        uint32_t history[HISTORY_LENGTH]; // cycle delays, oldest first
+    };
+
+    AdaptivePollScheduler(uint32_t burstIntervalMs, uint32_t initialIntervalMs, uint32_t ceilingIntervalMs,
+                          uint32_t burstCycles, uint32_t controlCeilingMs);
+
+    void setPolicy(uint32_t burstIntervalMs, uint32_t ceilingIntervalMs, uint32_t burstCycles);
+
+    // Records one poll cycle and returns the delay before the next one.
+    // The pixel backoff only grows on cycles that polled the pixel pins.
+    uint32_t nextIntervalMs(bool remoteChanged, bool pixelsPolled);
+
+    uint32_t getCurrentIntervalMs() const;
+    uint32_t getPixelIntervalMs() const;
+    Stats getStats() const;
+
+private:
+    uint32_t burstIntervalMs;
+    uint32_t ceilingIntervalMs;
+    uint32_t burstCycles;
+    uint32_t controlCeilingMs;
+
+    uint32_t currentIntervalMs;
+    uint32_t pixelIntervalMs;
+    uint32_t burstRemaining;
+    uint32_t cycles;
+    uint32_t burstEntries;
+
+    uint32_t history[HISTORY_LENGTH];
+    size_t historyHead;
+    size_t historyCount;
+};
@@ -0,0 +1,453 @@
+//BlynkHttpSession.cpp
+#include "BlynkHttpSession.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_crt_bundle.h"
+#include "sdkconfig.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char* TAG = "BlynkHttpSession";
+
+BlynkHttpSession::BlynkHttpSession(const std::string& baseURL)
+    : baseURL(baseURL), dnsCache(nullptr), usingCachedAddress(false), tlsEnabled(false), serverCertPem(nullptr),
+      client(nullptr), sessionMutex(nullptr), responseSink(nullptr), responseSinkSize(0), responseSinkLength(0),
+      connectedDuringRequest(false), sessionSaved(false), stats{}, tlsStats{}, performStartUs(0), headersSentUs(0), firstHeaderUs(0),
+      connectDurationMs(0), attemptTiming{},
+      breaker(BREAKER_FAILURE_THRESHOLD, BREAKER_BASE_OPEN_MS, BREAKER_MAX_OPEN_MS),
+      breakerState(CircuitBreaker::CLOSED), breakerListener(nullptr),
+      breakerListenerContext(nullptr), urlBuffer{} {
+    applyBaseURL(baseURL);
+
+    sessionMutex = xSemaphoreCreateMutex();
+    if (sessionMutex == nullptr) {
+        ESP_LOGE(TAG, "Failed to create session mutex");
+    }
+}
+
+BlynkHttpSession::~BlynkHttpSession() {
+    if (client) {
+        esp_http_client_cleanup(client);
+        client = nullptr;
+    }
+    if (sessionMutex) {
+        vSemaphoreDelete(sessionMutex);
+        sessionMutex = nullptr;
+    }
+}
+
+void BlynkHttpSession::parseBaseURL(const std::string& url, URLParts& parts) {
+    std::string trimmed = url;
+    if (!trimmed.empty() && trimmed.back() == '/') {
+        trimmed.pop_back();
+    }
+
+    // scheme://host[:port][/path]
+    size_t hostStart = trimmed.find("://");
+    hostStart = hostStart == std::string::npos ? 0 : hostStart + 3;
+    size_t pathStart = trimmed.find('/', hostStart);
+    if (pathStart == std::string::npos) {
+        pathStart = trimmed.size();
+    }
+    size_t portStart = trimmed.find(':', hostStart);
+    size_t hostEnd = portStart < pathStart ? portStart : pathStart;
+
+    parts.scheme = trimmed.substr(0, hostStart);
+    parts.host = trimmed.substr(hostStart, hostEnd - hostStart);
+    parts.hostHeader = trimmed.substr(hostStart, pathStart - hostStart);
+    parts.suffix = trimmed.substr(hostEnd);
+
+    parts.port = parts.scheme == "https://" ? 443 : 80;
+    if (hostEnd < pathStart) {
+        parts.port = static_cast<uint16_t>(atoi(trimmed.c_str() + hostEnd + 1));
+    }
+}
+
+void BlynkHttpSession::applyBaseURL(const std::string& url) {
+    URLParts parts;
+    parseBaseURL(url, parts);
+
+    baseURL = url;
+    if (!baseURL.empty() && baseURL.back() == '/') {
+        baseURL.pop_back();
+    }
+    scheme = parts.scheme;
+    hostHeader = parts.hostHeader;
+    hostSuffix = parts.suffix;
+    tlsEnabled = (parts.scheme == "https://");
+    tlsHostName = parts.host;
+    tlsStats.enabled = tlsEnabled;
+}
+
+void BlynkHttpSession::setBaseURL(const std::string& url, DnsCache* cache) {
+    if (sessionMutex == nullptr || xSemaphoreTake(sessionMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    std::string previousURL = baseURL;
+    applyBaseURL(url);
+    dnsCache = cache;
+    if (client && baseURL != previousURL) {
+        // Recreated on the next request, so the TLS name matches the new
+        // host; the first connection there is a full handshake
+        esp_http_client_cleanup(client);
+        client = nullptr;
+    }
+    // New server, clean slate for the breaker
+    breaker.recordSuccess();
+    updateBreakerState();
+
+    xSemaphoreGive(sessionMutex);
+    ESP_LOGI(TAG, "Routing Blynk traffic to %s", url.c_str());
+}
+
+bool BlynkHttpSession::ensureClient() {
+    if (client) {
+        return true;
+    }
+
+    esp_http_client_config_t config = {};
+    config.url = baseURL.c_str();
+    config.method = HTTP_METHOD_GET;
+    config.timeout_ms = TIMEOUT_MS;
+    config.keep_alive_enable = true;
+    config.event_handler = httpEventHandler;
+    config.user_data = this;
+
+    if (tlsEnabled) {
+        if (serverCertPem) {
+            config.cert_pem = serverCertPem;
+        } else {
+            config.crt_bundle_attach = esp_crt_bundle_attach;
+        }
+        // Requests may go to a cached IP, so name the host explicitly
+        config.common_name = tlsHostName.c_str();
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        config.save_client_session = true;
+#endif
+    }
+
+    client = esp_http_client_init(&config);
+    if (!client) {
+        ESP_LOGE(TAG, "Failed to init HTTP client");
+        return false;
+    }
+    sessionSaved = false;
+
+    ESP_LOGI(TAG, "%s session created for %s", tlsEnabled ? "HTTPS" : "HTTP", baseURL.c_str());
+    return true;
+}
+
+esp_err_t BlynkHttpSession::httpEventHandler(esp_http_client_event_t* evt) {
+    BlynkHttpSession* session = static_cast<BlynkHttpSession*>(evt->user_data);
+
+    switch (evt->event_id) {
+        case HTTP_EVENT_ON_CONNECTED:
+            // Fires once TCP (and TLS) setup is done
+            session->connectedDuringRequest = true;
+            session->connectDurationMs = static_cast<uint32_t>((esp_timer_get_time() - session->performStartUs) / 1000);
+            break;
+
+        case HTTP_EVENT_HEADERS_SENT:
+            session->headersSentUs = esp_timer_get_time();
+            break;
+
+        case HTTP_EVENT_ON_HEADER:
+            if (session->firstHeaderUs == 0) {
+                session->firstHeaderUs = esp_timer_get_time();
+            }
+            break;
+
+        case HTTP_EVENT_ON_DATA:
+            if (session->responseSink) {
+                size_t room = session->responseSinkSize - 1 - session->responseSinkLength;
+                size_t len = static_cast<size_t>(evt->data_len) < room ? evt->data_len : room;
+                memcpy(session->responseSink + session->responseSinkLength, evt->data, len);
+                session->responseSinkLength += len;
+                session->responseSink[session->responseSinkLength] = '\0';
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t BlynkHttpSession::performOnce(std::string_view body, int* statusCode) {
+    responseSinkLength = 0;
+    responseSink[0] = '\0';
+    connectedDuringRequest = false;
+
+    esp_http_client_set_url(client, urlBuffer);
+    if (usingCachedAddress) {
+        esp_http_client_set_header(client, "Host", hostHeader.c_str());
+    }
+    if (body.empty()) {
+        esp_http_client_set_method(client, HTTP_METHOD_GET);
+        esp_http_client_set_post_field(client, nullptr, 0);
+        esp_http_client_delete_header(client, "Content-Type");
+    } else {
+        esp_http_client_set_method(client, HTTP_METHOD_POST);
+        esp_http_client_set_header(client, "Content-Type", "application/json");
+        esp_http_client_set_post_field(client, body.data(), static_cast<int>(body.size()));
+    }
+    performStartUs = esp_timer_get_time();
+    headersSentUs = 0;
+    firstHeaderUs = 0;
+    esp_err_t err = esp_http_client_perform(client);
+
+    int64_t endUs = esp_timer_get_time();
+    attemptTiming.connectMs = connectedDuringRequest ? connectDurationMs : 0;
+    attemptTiming.connected = connectedDuringRequest;
+    attemptTiming.answered = (firstHeaderUs != 0);
+    if (firstHeaderUs != 0) {
+        int64_t sentUs = headersSentUs != 0 ? headersSentUs : performStartUs;
+        attemptTiming.headersMs = static_cast<uint32_t>((firstHeaderUs - sentUs) / 1000);
+        attemptTiming.bodyMs = static_cast<uint32_t>((endUs - firstHeaderUs) / 1000);
+    } else {
+        attemptTiming.headersMs = 0;
+        attemptTiming.bodyMs = 0;
+    }
+
+    if (connectedDuringRequest && tlsEnabled) {
+        handshakeStats.record(connectDurationMs, sessionSaved);
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        // The client keeps this session and offers it on the next connect
+        sessionSaved = true;
+#endif
+    }
+
+    if (err == ESP_OK) {
+        if (connectedDuringRequest) {
+            stats.newConnections++;
+        } else {
+            stats.reusedConnections++;
+        }
+        if (statusCode) {
+            *statusCode = esp_http_client_get_status_code(client);
+        }
+    }
+
+    return err;
+}
+
+esp_err_t BlynkHttpSession::get(const char* pathAndQuery, char* response, size_t responseSize,
+                                size_t* responseLength, int* statusCode, Timing* timing) {
+    return execute(pathAndQuery, std::string_view(), response, responseSize, responseLength, statusCode, timing);
+}
+
+esp_err_t BlynkHttpSession::post(const char* pathAndQuery, std::string_view body, char* response, size_t responseSize,
+                                 size_t* responseLength, int* statusCode, Timing* timing) {
+    if (body.empty()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return execute(pathAndQuery, body, response, responseSize, responseLength, statusCode, timing);
+}
+
+esp_err_t BlynkHttpSession::execute(const char* pathAndQuery, std::string_view body, char* response, size_t responseSize,
+                                    size_t* responseLength, int* statusCode, Timing* timing) {
+    if (response == nullptr || responseSize == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t startUs = esp_timer_get_time();
+    if (sessionMutex == nullptr || xSemaphoreTake(sessionMutex, pdMS_TO_TICKS(2 * TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "HTTP session busy");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    attemptTiming = {};
+    responseSink = response;
+    responseSinkSize = responseSize;
+    esp_err_t err = executeLocked(pathAndQuery, body, statusCode);
+    if (responseLength) {
+        *responseLength = responseSinkLength;
+    }
+    responseSink = nullptr;
+    responseSinkLength = 0;
+
+    if (timing) {
+        *timing = attemptTiming;
+        timing->totalMs = static_cast<uint32_t>((esp_timer_get_time() - startUs) / 1000);
+    }
+
+    xSemaphoreGive(sessionMutex);
+    return err;
+}
+
+// Caller holds sessionMutex and has set responseSink
+esp_err_t BlynkHttpSession::executeLocked(const char* pathAndQuery, std::string_view body, int* statusCode) {
+    if (!ensureClient()) {
+        return ESP_FAIL;
+    }
+
+    if (!admitRequest()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!formatURL(pathAndQuery)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    stats.requests++;
+    tlsStats.requests++;
+
+    esp_err_t err = performOnce(body, statusCode);
+    if (err != ESP_OK && err != ESP_ERR_HTTP_CONNECT) {
+        // Server most likely closed the kept-alive connection, start over once.
+        // A failed connect means the server is down, retrying only doubles the wait.
+        ESP_LOGW(TAG, "Request failed (%s), reconnecting", esp_err_to_name(err));
+        esp_http_client_close(client);
+        stats.reconnects++;
+        err = performOnce(body, statusCode);
+    }
+
+    if (err != ESP_OK) {
+        stats.failures++;
+        esp_http_client_close(client);
+        if (dnsCache) {
+            dnsCache->markStale();
+        }
+        breaker.recordFailure(static_cast<uint32_t>(esp_timer_get_time() / 1000));
+    } else {
+        // Any HTTP answer, even an error status, means the server is reachable
+        breaker.recordSuccess();
+    }
+    updateBreakerState();
+    return err;
+}
+
+// Caller holds sessionMutex and has set responseSink
+bool BlynkHttpSession::admitRequest() {
+    CircuitBreaker::State before = breaker.getState();
+    CircuitBreaker::Decision decision = breaker.check(static_cast<uint32_t>(esp_timer_get_time() / 1000));
+
+    if (decision == CircuitBreaker::REJECT) {
+        stats.rejected++;
+        updateBreakerState();
+        return false;
+    }
+
+    if (decision == CircuitBreaker::PROBE && !probePath.empty()) {
+        // Probe with the cheap request; the real one only goes out if it answers
+        esp_err_t err = formatURL(probePath.c_str()) ? performOnce(std::string_view(), nullptr) : ESP_ERR_INVALID_SIZE;
+        if (err != ESP_OK) {
+            esp_http_client_close(client);
+            breaker.recordFailure(static_cast<uint32_t>(esp_timer_get_time() / 1000));
+            updateBreakerState();
+            ESP_LOGW(TAG, "Blynk probe failed (%s), next probe in %lu ms", esp_err_to_name(err),
+                     (unsigned long)breaker.getOpenIntervalMs());
+            return false;
+        }
+        breaker.recordSuccess();
+    }
+
+    if (before == CircuitBreaker::CLOSED && breaker.getState() == CircuitBreaker::CLOSED) {
+        return true;
+    }
+
+    updateBreakerState();
+    if (breaker.getState() == CircuitBreaker::CLOSED) {
+        ESP_LOGI(TAG, "Blynk reachable again, circuit closed");
+    }
+    return true;
+}
+
+// Caller holds sessionMutex
+bool BlynkHttpSession::formatURL(const char* pathAndQuery) {
+    char address[16];
+    int urlLength;
+
+    usingCachedAddress = dnsCache != nullptr && dnsCache->getAddress(address, sizeof(address));
+    if (usingCachedAddress) {
+        urlLength = snprintf(urlBuffer, sizeof(urlBuffer), "%s%s%s%s", scheme.c_str(), address, hostSuffix.c_str(), pathAndQuery);
+    } else {
+        urlLength = snprintf(urlBuffer, sizeof(urlBuffer), "%s%s", baseURL.c_str(), pathAndQuery);
+    }
+    if (urlLength < 0 || static_cast<size_t>(urlLength) >= sizeof(urlBuffer)) {
+        ESP_LOGE(TAG, "URL too long (%d bytes)", urlLength);
+        return false;
+    }
+    return true;
+}
+
+void BlynkHttpSession::setProbePath(const std::string& path) {
+    if (sessionMutex == nullptr || xSemaphoreTake(sessionMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    probePath = path;
+    xSemaphoreGive(sessionMutex);
+}
+
+CircuitBreaker::State BlynkHttpSession::getBreakerState() const {
+    return breakerState;
+}
+
+void BlynkHttpSession::setBreakerListener(BreakerListener listener, void* context) {
+    if (sessionMutex == nullptr || xSemaphoreTake(sessionMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    breakerListener = listener;
+    breakerListenerContext = context;
+    xSemaphoreGive(sessionMutex);
+}
+
+// Caller holds sessionMutex
+void BlynkHttpSession::updateBreakerState() {
+    CircuitBreaker::State state = breaker.getState();
+    if (breakerState.exchange(state) != state && breakerListener) {
+        breakerListener(breakerListenerContext, state);
+    }
+}
+
+void BlynkHttpSession::close() {
+    if (sessionMutex == nullptr || xSemaphoreTake(sessionMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    if (client) {
+        esp_http_client_close(client);
+    }
+
+    xSemaphoreGive(sessionMutex);
+}
+
+BlynkHttpSession::Stats BlynkHttpSession::takeCycleStats() {
+    Stats snapshot = {};
+    if (sessionMutex && xSemaphoreTake(sessionMutex, portMAX_DELAY) == pdTRUE) {
+        snapshot = stats;
+        stats = {};
+        xSemaphoreGive(sessionMutex);
+    }
+    return snapshot;
+}
+
+BlynkHttpSession::TlsStats BlynkHttpSession::getTlsStats() const {
+    TlsStats snapshot = {};
+    if (sessionMutex && xSemaphoreTake(sessionMutex, portMAX_DELAY) == pdTRUE) {
+        snapshot = tlsStats;
+        snapshot.handshakes = handshakeStats.getStats();
+        xSemaphoreGive(sessionMutex);
+    }
+    return snapshot;
+}
+
+void BlynkHttpSession::setServerCertificate(const char* pem) {
+    if (sessionMutex == nullptr || xSemaphoreTake(sessionMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    if (client && pem != serverCertPem) {
+        // The saved session was verified against the old trust anchor, drop it too
+        esp_http_client_cleanup(client);
+        client = nullptr;
+    }
+    serverCertPem = pem;
+    xSemaphoreGive(sessionMutex);
+}
+
+const std::string& BlynkHttpSession::getBaseURL() const {
+    return baseURL;
+}
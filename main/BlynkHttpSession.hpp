@@ -0,0 +1,147 @@
+//BlynkHttpSession.hpp
+#pragma once
+
+#include "CircuitBreaker.hpp"
+#include "DnsCache.hpp"
+#include "TlsHandshakeStats.hpp"
+#include "esp_http_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <atomic>
+#include <string>
+#include <string_view>
+
+// Long-lived HTTP client that keeps one keep-alive connection to the Blynk
+// server open across requests instead of doing init/cleanup per call.
+// A circuit breaker fails requests instantly while the server is unreachable
+// and lets a single cheap probe through on a backoff schedule. An https://
+// base URL switches to TLS; the kept-alive connection then amortizes the
+// handshake, and reconnects resume the saved TLS session when
+// CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS is enabled. The session lives in the
+// client, so it survives reconnects but not a change of server.
+class BlynkHttpSession {
+public:
+    // Called on the requesting task, with the session locked, when the breaker changes state
+    typedef void (*BreakerListener)(void* context, CircuitBreaker::State state);
+
+    // Connection reuse counters, reset by takeCycleStats()
+    struct Stats {
+        uint32_t requests;
+        uint32_t newConnections;
+        uint32_t reusedConnections;
+        uint32_t reconnects;
+        uint32_t failures;
+        uint32_t rejected;    // failed fast by the open breaker
+    };
+
+    // Lifetime TLS counters (all zero for plain HTTP)
+    struct TlsStats {
+        bool enabled;
+        uint32_t requests;
+        TlsHandshakeStats::Stats handshakes;  // one per new connection; resumed/full is an estimate
+    };
+
+    // Where the time of one request went; phases not reached stay 0.
+    // Phases cover the last attempt, total the whole call including retries.
+    struct Timing {
+        uint32_t connectMs;   // only for a new connection
+        uint32_t headersMs;   // request sent until the first response header
+        uint32_t bodyMs;      // first header until the response is complete
+        uint32_t totalMs;
+        bool connected;       // the last attempt opened a new connection
+        bool answered;        // response headers arrived
+    };
+
+    struct URLParts {
+        std::string scheme;      // "http://"
+        std::string host;        // "blynk.cloud"
+        std::string hostHeader;  // host[:port]
+        std::string suffix;      // [:port][/base path]
+        uint16_t port;
+    };
+    static void parseBaseURL(const std::string& url, URLParts& parts);
+
+    explicit BlynkHttpSession(const std::string& baseURL);
+    ~BlynkHttpSession();
+
+    // Performs a GET on baseURL + pathAndQuery, reconnecting once if the
+    // server dropped the kept-alive connection. The body is written to the
+    // caller's buffer (NUL terminated, truncated to responseSize - 1).
+    esp_err_t get(const char* pathAndQuery, char* response, size_t responseSize,
+                  size_t* responseLength, int* statusCode = nullptr, Timing* timing = nullptr);
+    // Same as get() but POSTs a JSON body
+    esp_err_t post(const char* pathAndQuery, std::string_view body, char* response, size_t responseSize,
+                   size_t* responseLength, int* statusCode = nullptr, Timing* timing = nullptr);
+    void close();
+
+    // Cheap GET used to probe a recovering server (e.g. isHardwareConnected)
+    void setProbePath(const std::string& path);
+    CircuitBreaker::State getBreakerState() const;
+    void setBreakerListener(BreakerListener listener, void* context);
+
+    // Moves all traffic to another server, connecting by the cached address
+    // of its host (with the real Host header) when a DNS cache is given.
+    // Resets the breaker. A different server drops the kept-alive connection
+    // and the saved TLS session with the client (a session is only good for
+    // the server that issued it); the current server keeps both.
+    void setBaseURL(const std::string& url, DnsCache* cache);
+
+    Stats takeCycleStats();
+    TlsStats getTlsStats() const;
+
+    // Trust this PEM certificate instead of the IDF certificate bundle, e.g.
+    // for a self-signed local test server. Must stay valid; call before start,
+    // as a new certificate also drops the saved TLS session.
+    void setServerCertificate(const char* pem);
+    const std::string& getBaseURL() const;
+
+private:
+    bool ensureClient();
+    esp_err_t execute(const char* pathAndQuery, std::string_view body, char* response, size_t responseSize,
+                      size_t* responseLength, int* statusCode, Timing* timing);
+    esp_err_t executeLocked(const char* pathAndQuery, std::string_view body, int* statusCode);
+    esp_err_t performOnce(std::string_view body, int* statusCode);
+    bool admitRequest();
+    void updateBreakerState();
+    bool formatURL(const char* pathAndQuery);
+    void applyBaseURL(const std::string& url);
+    static esp_err_t httpEventHandler(esp_http_client_event_t* evt);
+
+    std::string baseURL;
+    std::string scheme;       // "http://"
+    std::string hostHeader;   // host[:port]
+    std::string hostSuffix;   // [:port][/base path], appended after the address
+    DnsCache* dnsCache;
+    bool usingCachedAddress;
+    bool tlsEnabled;
+    std::string tlsHostName;      // certificate name/SNI, also when connecting by address
+    const char* serverCertPem;
+    esp_http_client_handle_t client;
+    SemaphoreHandle_t sessionMutex;
+    char* responseSink;
+    size_t responseSinkSize;
+    size_t responseSinkLength;
+    bool connectedDuringRequest;
+    bool sessionSaved;        // the client holds a TLS session it can offer on reconnect
+    Stats stats;
+    TlsStats tlsStats;
+    TlsHandshakeStats handshakeStats;
+    int64_t performStartUs;
+    int64_t headersSentUs;
+    int64_t firstHeaderUs;
+    uint32_t connectDurationMs;
+    Timing attemptTiming;
+    std::string probePath;
+    CircuitBreaker breaker;                          // guarded by sessionMutex
+    std::atomic<CircuitBreaker::State> breakerState;  // lock-free copy for readers
+    BreakerListener breakerListener;
+    void* breakerListenerContext;
+
+    static constexpr int TIMEOUT_MS = 5000;
+    static constexpr uint32_t BREAKER_FAILURE_THRESHOLD = 3;
+    static constexpr uint32_t BREAKER_BASE_OPEN_MS = 5000;
+    static constexpr uint32_t BREAKER_MAX_OPEN_MS = 120000;
+    static constexpr size_t MAX_URL_LENGTH = 384;
+
+    char urlBuffer[MAX_URL_LENGTH];  // preallocated so requests never touch the heap
+};
@@ -0,0 +1,199 @@
+//BlynkLatencyStats.cpp
+#include "BlynkLatencyStats.hpp"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include <cstdio>
+
+static const char* TAG = "BlynkLatencyStats";
+
+static const char* const PHASE_NAMES[BlynkLatencyStats::PHASE_COUNT] = { "connect", "headers", "body", "total" };
+static const char* const ERROR_NAMES[BlynkLatencyStats::ERROR_COUNT] = { "connect", "timeout", "rejected", "status", "other", "push" };
+
+BlynkLatencyStats::BlynkLatencyStats() {
+    reset();
+}
+
+int BlynkLatencyStats::bucketFor(uint32_t ms) {
+    for (int i = 0; i < BUCKET_COUNT - 1; ++i) {
+        if (ms <= BUCKET_LIMITS_MS[i]) {
+            return i;
+        }
+    }
+    return BUCKET_COUNT - 1;
+}
+
+void BlynkLatencyStats::record(uint32_t pinMask, Phase phase, uint32_t ms) {
+    if (phase >= PHASE_COUNT) {
+        return;
+    }
+
+    int bucket = bucketFor(ms);
+    usedPins.fetch_or(pinMask, std::memory_order_relaxed);
+    for (int pin = 0; pin < MAX_PINS; ++pin) {
+        if ((pinMask & (1UL << pin)) == 0) {
+            continue;
+        }
+        buckets[pin][phase][bucket].fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t previous = maxMs[pin][phase].load(std::memory_order_relaxed);
+        while (ms > previous && !maxMs[pin][phase].compare_exchange_weak(previous, ms, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+void BlynkLatencyStats::recordError(uint32_t pinMask, ErrorType type) {
+    if (type >= ERROR_COUNT) {
+        return;
+    }
+
+    usedPins.fetch_or(pinMask, std::memory_order_relaxed);
+    for (int pin = 0; pin < MAX_PINS; ++pin) {
+        if (pinMask & (1UL << pin)) {
+            errors[pin][type].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+BlynkLatencyStats::ErrorType BlynkLatencyStats::classify(esp_err_t err, int statusCode) {
+    switch (err) {
+        case ESP_OK:
+            return statusCode == 200 ? ERROR_COUNT : ERROR_HTTP_STATUS;
+        case ESP_ERR_HTTP_CONNECT:
+            return ERROR_CONNECT;
+        case ESP_ERR_TIMEOUT:
+        case ESP_ERR_HTTP_EAGAIN:
+            return ERROR_TIMEOUT;
+        case ESP_ERR_INVALID_STATE:
+            return ERROR_REJECTED;
+        default:
+            return ERROR_OTHER;
+    }
+}
+
+void BlynkLatencyStats::recordRequest(uint32_t pinMask, esp_err_t err, int statusCode,
+                                      const BlynkHttpSession::Timing& timing) {
+    if (pinMask == 0) {
+        return;
+    }
+
+    if (timing.connected) {
+        record(pinMask, PHASE_CONNECT, timing.connectMs);
+    }
+    if (timing.answered) {
+        record(pinMask, PHASE_HEADERS, timing.headersMs);
+        record(pinMask, PHASE_BODY, timing.bodyMs);
+    }
+    record(pinMask, PHASE_TOTAL, timing.totalMs);
+
+    ErrorType type = classify(err, statusCode);
+    if (type != ERROR_COUNT) {
+        recordError(pinMask, type);
+    }
+}
+
+void BlynkLatencyStats::recordPushWrite(uint32_t pinMask, esp_err_t err, uint32_t sendMs) {
+    if (pinMask == 0) {
+        return;
+    }
+
+    record(pinMask, PHASE_TOTAL, sendMs);
+    if (err != ESP_OK) {
+        recordError(pinMask, ERROR_PUSH);
+    }
+}
+
+BlynkLatencyStats::Histogram BlynkLatencyStats::getHistogram(int pin, Phase phase) const {
+    Histogram histogram = {};
+    if (pin < 0 || pin >= MAX_PINS || phase >= PHASE_COUNT) {
+        return histogram;
+    }
+
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        histogram.buckets[i] = buckets[pin][phase][i].load(std::memory_order_relaxed);
+        histogram.count += histogram.buckets[i];
+    }
+    histogram.maxMs = maxMs[pin][phase].load(std::memory_order_relaxed);
+    return histogram;
+}
+
+uint32_t BlynkLatencyStats::getErrorCount(int pin, ErrorType type) const {
+    if (pin < 0 || pin >= MAX_PINS || type >= ERROR_COUNT) {
+        return 0;
+    }
+    return errors[pin][type].load(std::memory_order_relaxed);
+}
+
+uint32_t BlynkLatencyStats::percentileMs(const Histogram& histogram, uint32_t percent) {
+    if (histogram.count == 0) {
+        return 0;
+    }
+
+    uint64_t target = (static_cast<uint64_t>(histogram.count) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT - 1; ++i) {
+        seen += histogram.buckets[i];
+        if (seen >= target) {
+            return BUCKET_LIMITS_MS[i];
+        }
+    }
+    return histogram.maxMs;
+}
+
+void BlynkLatencyStats::dump() const {
+    uint32_t pins = usedPins.load(std::memory_order_relaxed);
+    if (pins == 0) {
+        ESP_LOGI(TAG, "No Blynk requests recorded yet");
+        return;
+    }
+
+    char line[160];
+    for (int pin = 0; pin < MAX_PINS; ++pin) {
+        if ((pins & (1UL << pin)) == 0) {
+            continue;
+        }
+
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            Histogram histogram = getHistogram(pin, static_cast<Phase>(phase));
+            if (histogram.count == 0) {
+                continue;
+            }
+
+            int length = 0;
+            for (int i = 0; i < BUCKET_COUNT && length < static_cast<int>(sizeof(line)); ++i) {
+                length += snprintf(line + length, sizeof(line) - length, "%s%lu", i == 0 ? "" : " ",
+                                   (unsigned long)histogram.buckets[i]);
+            }
+            ESP_LOGI(TAG, "V%d %-7s n=%lu p50<=%lu p90<=%lu max=%lu ms [%s]", pin, PHASE_NAMES[phase],
+                     (unsigned long)histogram.count, (unsigned long)percentileMs(histogram, 50),
+                     (unsigned long)percentileMs(histogram, 90), (unsigned long)histogram.maxMs, line);
+        }
+
+        int length = 0;
+        for (int type = 0; type < ERROR_COUNT && length < static_cast<int>(sizeof(line)); ++type) {
+            length += snprintf(line + length, sizeof(line) - length, "%s%s=%lu", type == 0 ? "" : " ",
+                               ERROR_NAMES[type], (unsigned long)getErrorCount(pin, static_cast<ErrorType>(type)));
+        }
+        ESP_LOGI(TAG, "V%d errors: %s", pin, line);
+    }
+
+    int length = 0;
+    for (int i = 0; i < BUCKET_COUNT - 1 && length < static_cast<int>(sizeof(line)); ++i) {
+        length += snprintf(line + length, sizeof(line) - length, "<=%lu ", (unsigned long)BUCKET_LIMITS_MS[i]);
+    }
+    ESP_LOGI(TAG, "Buckets (ms): %s>%lu", line, (unsigned long)BUCKET_LIMITS_MS[BUCKET_COUNT - 2]);
+}
+
+void BlynkLatencyStats::reset() {
+    for (int pin = 0; pin < MAX_PINS; ++pin) {
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            for (int i = 0; i < BUCKET_COUNT; ++i) {
+                buckets[pin][phase][i].store(0, std::memory_order_relaxed);
+            }
+            maxMs[pin][phase].store(0, std::memory_order_relaxed);
+        }
+        for (int type = 0; type < ERROR_COUNT; ++type) {
+            errors[pin][type].store(0, std::memory_order_relaxed);
+        }
+    }
+    usedPins.store(0, std::memory_order_relaxed);
+}
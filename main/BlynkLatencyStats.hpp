@@ -0,0 +1,73 @@
+//BlynkLatencyStats.hpp
+#pragma once
+
+#include "BlynkHttpSession.hpp"
+#include "BlynkPinRegistry.hpp"
+#include "esp_err.h"
+#include <atomic>
+#include <cstdint>
+
+// Fixed-bucket latency histograms for Blynk requests, one set per virtual pin
+// and request phase, plus per-pin error counters. Recording is lock-free
+// (relaxed atomic increments) so any transport task can feed it; dump() logs
+// a snapshot on demand.
+class BlynkLatencyStats {
+public:
+    enum Phase {
+        PHASE_CONNECT = 0,  // TCP (and TLS) setup, only for new connections
+        PHASE_HEADERS,      // request sent until the first response header
+        PHASE_BODY,         // first header until the response is complete
+        PHASE_TOTAL,        // whole request as seen by the caller, retries included
+        PHASE_COUNT
+    };
+
+    enum ErrorType {
+        ERROR_CONNECT = 0,  // server unreachable
+        ERROR_TIMEOUT,
+        ERROR_REJECTED,     // failed fast by the circuit breaker
+        ERROR_HTTP_STATUS,  // answered, but not with 200
+        ERROR_OTHER,
+        ERROR_PUSH,         // push transport write failed (link down or send error)
+        ERROR_COUNT         // also "no error" from classify()
+    };
+
+    static constexpr int MAX_PINS = BlynkPinRegistry::maxPinNumber() + 1;
+    static constexpr int BUCKET_COUNT = 10;
+    // Upper bound of each bucket in ms; the last bucket takes everything above
+    static constexpr uint32_t BUCKET_LIMITS_MS[BUCKET_COUNT - 1] = { 10, 25, 50, 100, 250, 500, 1000, 2500, 5000 };
+
+    struct Histogram {
+        uint32_t buckets[BUCKET_COUNT];
+        uint32_t count;
+        uint32_t maxMs;
+    };
+
+    BlynkLatencyStats();
+
+    // A request that carried several pins counts once for each of them
+    void record(uint32_t pinMask, Phase phase, uint32_t ms);
+    void recordError(uint32_t pinMask, ErrorType type);
+    // Maps a request result to its error type, ERROR_COUNT when it succeeded
+    static ErrorType classify(esp_err_t err, int statusCode);
+    // Records every phase the request reached and its error type, if any
+    void recordRequest(uint32_t pinMask, esp_err_t err, int statusCode, const BlynkHttpSession::Timing& timing);
+    // A write over the push transport: no reply, so only the send time, and
+    // any failure counts as ERROR_PUSH whatever the transport returned
+    void recordPushWrite(uint32_t pinMask, esp_err_t err, uint32_t sendMs);
+
+    Histogram getHistogram(int pin, Phase phase) const;
+    uint32_t getErrorCount(int pin, ErrorType type) const;
+    // Bucket upper bound below which `percent` of the samples fall
+    static uint32_t percentileMs(const Histogram& histogram, uint32_t percent);
+
+    void dump() const;
+    void reset();
+
+private:
+    static int bucketFor(uint32_t ms);
+
+    std::atomic<uint32_t> buckets[MAX_PINS][PHASE_COUNT][BUCKET_COUNT];
+    std::atomic<uint32_t> maxMs[MAX_PINS][PHASE_COUNT];
+    std::atomic<uint32_t> errors[MAX_PINS][ERROR_COUNT];
+    std::atomic<uint32_t> usedPins;
+};
@@ -1,317 +1,1163 @@
 // BlynkManager.cpp
 #include "BlynkManager.hpp"
-#include "DHTSensor.hpp"
+#include "ClimateSource.hpp"
+#include "DeciValue.hpp"
 #include "HumidifierController.hpp"
 #include "PixelManager.hpp"
+#include "HeapMonitor.hpp"
 #include "esp_log.h"
-#include "esp_http_client.h"
-#include <cstdlib>
+#include "esp_timer.h"
+#include <charconv>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <sys/time.h>
 
 static const char* TAG = "BlynkManager";
 
-BlynkManager::BlynkManager(const std::string& authToken, const std::string& baseURL, DHTSensor* dhtSensor, HumidifierController* humidifierController, PixelManager* pixelManager)
-    : authToken(authToken), baseURL(baseURL), dhtSensor(dhtSensor), humidifierController(humidifierController), pixelManager(pixelManager), autoMode(true), manualSwitchOn(false) {}
+// Appends printf-style text at buffer + length, returns false once it no longer fits
+static bool appendFormat(char* buffer, size_t size, size_t& length, const char* format, ...) {
+    if (length >= size) {
+        return false;
+    }
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + length, size - length, format, args);
+    va_end(args);
+
+    if (written < 0 || static_cast<size_t>(written) >= size - length) {
+        length = size;
+        return false;
+    }
+    length += written;
+    return true;
+}
+
+// Parses a leading integer/float like std::stoi/std::stof, without allocating
+static bool parseInt(std::string_view text, int& value) {
+    return std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc();
+}
+
+static bool parseFloat(std::string_view text, float& value) {
+    return std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc();
+}
+
+BlynkManager::BlynkManager(const std::string& authToken, const std::string& baseURL, ClimateSource* climateSource, HumidifierController* humidifierController, PixelManager* pixelManager)
+    : authToken(authToken), baseURL(baseURL), climateSource(climateSource), humidifierController(humidifierController), pixelManager(pixelManager),
+      workingConfig{ 0, true, false, 0.0f, 0, 0, 0, 0, 0 }, configMutex(xSemaphoreCreateMutex()), sharedConfig(workingConfig),
+      httpSession(baseURL),
+      servers(DNS_TTL_MS), activeServer(0), lastServerProbeMs(0),
+      pendingWrites{}, pendingWriteMask(0), pushWrites{}, writeMutex(xSemaphoreCreateMutex()),
+      telemetryChannels{},
+      publishDeadbandTenths(DEFAULT_PUBLISH_DEADBAND_TENTHS), publishHeartbeatMs(DEFAULT_HEARTBEAT_MS), publishStats{}, lastSampleSequence(0),
+      lastLatencyDumpMs(0), requestEngine(&httpSession, &latencyStats), groupReadPending{}, writePending(false),
+      pollScheduler(DEFAULT_BURST_INTERVAL_MS, INITIAL_POLL_INTERVAL_MS, DEFAULT_POLL_CEILING_MS, DEFAULT_BURST_CYCLES,
+                    CONTROL_POLL_CEILING_MS), nextPixelPollMs(0),
+      monitorTaskHandle(nullptr), remoteChanged(false), remoteValues{}, remoteValueMask(0),
+      httpLinkUp(true), inFlightWriteMask(0), failedWriteMask(0), drainState(DRAIN_IDLE), drainChannel(0),
+      drainEndSeq(0), drainSampleCount(0), lastDrainMs(0), lastBacklogCheckMs(0), drainedSamples(0), drainActiveMs(0), drainBody{},
+      pushTransport(nullptr), pushedColour{ -1, -1, -1 }, lastCycleHeapAllocations(0) {
+    if (writeMutex == nullptr) {
+        ESP_LOGE(TAG, "Failed to create write mutex");
+    }
+    if (configMutex == nullptr) {
+        ESP_LOGE(TAG, "Failed to create config mutex");
+    }
+    if (pixelManager) {
+        pixelManager->followConfig(&sharedConfig);
+    }
+
+    servers.addServer(baseURL);
+
+    // Cheapest authenticated endpoint, used to probe a recovering server
+    httpSession.setProbePath("/external/api/isHardwareConnected?token=" + authToken);
+    httpSession.setBreakerListener(onBreakerStateChanged, this);
+
+    size_t channel = 0;
+    for (const VirtualPinSpec& spec : BlynkPinRegistry::PINS) {
+        if (spec.group == VirtualPinSpec::GROUP_TELEMETRY) {
+            TelemetryChannel& telemetry = telemetryChannels[channel++];
+            telemetry.spec = &spec;
+            telemetry.minTenths = toTenths(spec.minValue);
+            telemetry.maxTenths = toTenths(spec.maxValue);
+        }
+    }
+}
+
+void BlynkManager::enableHardwareProtocol(const std::string& host, uint16_t port) {
+    if (monitorTaskHandle != nullptr) {
+        ESP_LOGW(TAG, "Transport can only be changed before start()");
+        return;
+    }
+    pushTransport = std::make_unique<BlynkTcpTransport>(host, port, authToken);
+    pushTransport->setHandlers(onPushedPinWrite, onPushConnected, this);
+}
+
+void BlynkManager::enableMqtt(const std::string& brokerUri, int qos) {
+    if (monitorTaskHandle != nullptr) {
+        ESP_LOGW(TAG, "Transport can only be changed before start()");
+        return;
+    }
+    pushTransport = std::make_unique<BlynkMqttTransport>(brokerUri, authToken, qos);
+    pushTransport->setHandlers(onPushedPinWrite, onPushConnected, this);
+}
 
 void BlynkManager::start() {
+    // Resolve (and with several candidates, rank) up front so the first
+    // requests already go to the right server by address
+    if (servers.getServerCount() > 1) {
+        servers.probeAll();
+        lastServerProbeMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    }
+    activeServer = servers.selectBest(0);
+    servers.getDnsCache(activeServer)->refresh();
+    routeTo(activeServer);
+
+    if (requestEngine.start() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start Blynk request engine");
+    }
+
+    if (pushTransport && pushTransport->start() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start Blynk %s transport, staying on HTTP", pushTransport->getName());
+    }
+
     BaseType_t result = xTaskCreate(
         blynkMonitorTask,
         "blynkMonitorTask",
         4096,
         this,
         1,
-        nullptr
+        &monitorTaskHandle
     );
 
     if (result != pdPASS) {
         ESP_LOGE(TAG, "Failed to create blynkMonitorTask");
-    } else {
-        ESP_LOGI(TAG, "Successfully created blynkMonitorTask");
+        return;
     }
+    ESP_LOGI(TAG, "Successfully created blynkMonitorTask");
+
+    // Telemetry goes out when a sample arrives, not on the next poll
+    climateSource->getSampleBus().subscribe(onNewSample, this);
+}
+
+void BlynkManager::onNewSample(void* context, const ClimateSample& sample) {
+    BlynkManager* manager = static_cast<BlynkManager*>(context);
+    xTaskNotify(manager->monitorTaskHandle, NOTIFY_NEW_SAMPLE, eSetBits);
+}
+
+void BlynkManager::addCandidateServer(const std::string& baseURL) {
+    if (monitorTaskHandle != nullptr) {
+        ESP_LOGW(TAG, "Servers can only be added before start()");
+        return;
+    }
+    servers.addServer(baseURL);
+}
+
+void BlynkManager::setServerCertificate(const char* pem) {
+    httpSession.setServerCertificate(pem);
+}
+
+void BlynkManager::maintainServerRoute(uint32_t nowMs) {
+    // Re-resolves here, off the request path, before the TTL runs out
+    servers.getDnsCache(activeServer)->refresh();
+
+    if (servers.getServerCount() < 2) {
+        return;
+    }
+
+    int next = activeServer;
+    if (getCloudState() == CircuitBreaker::OPEN) {
+        // Active server stopped answering, fail over to the best other one
+        servers.markUnhealthy(activeServer);
+        next = servers.selectBest(-1);
+        if (next < 0) {
+            next = activeServer;
+        }
+    }
+
+    if (next == activeServer && nowMs - lastServerProbeMs >= SERVER_PROBE_INTERVAL_MS) {
+        servers.probeAll();
+        lastServerProbeMs = nowMs;
+        next = servers.selectBest(activeServer);
+    }
+
+    if (next != activeServer) {
+        ESP_LOGW(TAG, "Switching Blynk server %s -> %s", servers.getBaseURL(activeServer).c_str(),
+                 servers.getBaseURL(next).c_str());
+        activeServer = next;
+        routeTo(activeServer);
+    }
+}
+
+void BlynkManager::routeTo(int server) {
+    httpSession.setBaseURL(servers.getBaseURL(server), servers.getDnsCache(server));
 }
 
 void BlynkManager::setPixelManager(PixelManager* manager){
     this->pixelManager = manager;
+    if (manager) {
+        manager->followConfig(&sharedConfig);
+    }
 }
 
 void BlynkManager::blynkMonitorTask(void* pvParameters) {
     BlynkManager* blynkManager = static_cast<BlynkManager*>(pvParameters);
-    const TickType_t xDelay = pdMS_TO_TICKS(3000);
+
+    HeapMonitor::watchCurrentTask();
+    if (!HeapMonitor::isAvailable()) {
+        ESP_LOGW(TAG, "Heap hooks disabled, allocation counter inactive (enable CONFIG_HEAP_USE_HOOKS)");
+    }
 
     vTaskDelay(pdMS_TO_TICKS(3000)); // Initial delay
 
     while (true) {
+        // With the push link up, app writes are pushed and there is nothing to poll
+        bool pushActive = blynkManager->isPushActive();
+        uint32_t nowMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+        bool pixelsDue = static_cast<int32_t>(nowMs - blynkManager->nextPixelPollMs) >= 0;
+
+        blynkManager->maintainServerRoute(nowMs);
         blynkManager->updateSensorReadings();
-        blynkManager->fetchControlMode();
-        blynkManager->fetchHumidityThreshold();
-        blynkManager->fetchPixelMode();
-        blynkManager->fetchPixelBrightness();
-        blynkManager->fetchPixelColor();
-        
-        if (!blynkManager->isAutoMode()) {
-            blynkManager->fetchManualSwitchState();
+        blynkManager->flushPinWrites();
+        if (!pushActive) {
+            blynkManager->fetchAllPins(pixelsDue);
         }
+        blynkManager->drainBacklog(static_cast<uint32_t>(esp_timer_get_time() / 1000));
+
+        blynkManager->logCycleStats();
 
-        vTaskDelay(xDelay);
+        // A remote change seen while waiting wakes the loop early
+        bool changed = blynkManager->remoteChanged.exchange(false);
+        uint32_t intervalMs = INITIAL_POLL_INTERVAL_MS;
+        if (!pushActive) {
+            // The backed-off interval paces the pixel pins; a mode or switch
+            // change from the app still arrives within the control ceiling
+            intervalMs = blynkManager->pollScheduler.nextIntervalMs(changed, pixelsDue);
+            if (pixelsDue || changed) {
+                blynkManager->nextPixelPollMs = nowMs + blynkManager->pollScheduler.getPixelIntervalMs();
+            }
+        }
+        ESP_LOGI(TAG, "Next poll in %lu ms", (unsigned long)intervalMs);
+        blynkManager->waitForNextPoll(intervalMs);
+    }
+}
+
+void BlynkManager::waitForNextPoll(uint32_t intervalMs) {
+    // Until the poll is due, upload each new sensor sample as it arrives;
+    // a remote change ends the wait early
+    uint32_t pollDueMs = static_cast<uint32_t>(esp_timer_get_time() / 1000) + intervalMs;
+    while (true) {
+        int32_t remainingMs = static_cast<int32_t>(pollDueMs - static_cast<uint32_t>(esp_timer_get_time() / 1000));
+        uint32_t events = 0;
+        if (remainingMs <= 0 || xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(remainingMs)) != pdTRUE) {
+            return;
+        }
+        if (events & NOTIFY_REMOTE_CHANGE) {
+            return;
+        }
+        if (events & NOTIFY_NEW_SAMPLE) {
+            updateSensorReadings();
+            flushPinWrites();
+        }
     }
 }
 
 void BlynkManager::updateSensorReadings() {
-    std::string tempStr = std::to_string(dhtSensor->getTemperature());
-    std::string humStr = std::to_string(dhtSensor->getHumidity());
-    sendToBlynk(0, tempStr);
-    sendToBlynk(1, humStr);
-    ESP_LOGI(TAG, "Updated Temp: %s, Hum: %s to Blynk", tempStr.c_str(), humStr.c_str());
-}
-
-void BlynkManager::fetchControlMode() {
-    std::string response = fetchFromBlynk(3);  // V3: mode (0 = Auto, 1 = Manual)
-    ESP_LOGI(TAG, "Control mode response: '%s'", response.c_str());
-    
-    if (response.empty()) {
-        ESP_LOGE(TAG, "Empty control mode response");
+    uint32_t nowMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    rebufferFailedWrites();
+
+    ClimateSample sample;
+    uint32_t sampleAgeMs = 0;
+    if (!climateSource->getFreshSample(ClimateSource::DEFAULT_MAX_SAMPLE_AGE_MS, sample, sampleAgeMs)) {
+        publishStats.staleCycles++;
+        ESP_LOGW(TAG, "No sensor sample in the last %lu ms, telemetry not published",
+                 (unsigned long)ClimateSource::DEFAULT_MAX_SAMPLE_AGE_MS);
         return;
     }
 
-    bool previousMode = autoMode;
-    autoMode = (response == "0");
+    // Each sample is considered once; after that only heartbeats repeat it
+    bool newSample = sample.sequence != lastSampleSequence;
+    lastSampleSequence = sample.sequence;
 
-    if (previousMode != autoMode) {
-        ESP_LOGI(TAG, "Control mode changed to: %s", autoMode ? "Auto" : "Manual");
+    for (TelemetryChannel& channel : telemetryChannels) {
+        int32_t tenths = readTelemetry(*channel.spec, sample);
+        if (tenths < channel.minTenths || tenths > channel.maxTenths) {
+            ESP_LOGW(TAG, "V%d value %ld tenths out of range, not published", channel.spec->pin, (long)tenths);
+            continue;
+        }
+        publishTelemetry(channel, tenths, newSample, sample.timestampMs, nowMs);
     }
+    ESP_LOGI(TAG, "Telemetry: sample #%lu (%lu ms old), %lu sent, %lu suppressed, %lu heartbeats",
+             (unsigned long)sample.sequence, (unsigned long)sampleAgeMs,
+             (unsigned long)publishStats.sent, (unsigned long)publishStats.suppressed,
+             (unsigned long)publishStats.heartbeats);
+}
 
-    if (!autoMode) {
-        fetchManualSwitchState();
+int32_t BlynkManager::readTelemetry(const VirtualPinSpec& spec, const ClimateSample& sample) {
+    switch (spec.handler) {
+        case VirtualPinSpec::HANDLER_TEMPERATURE:
+            return sample.temperature.tenths;
+        case VirtualPinSpec::HANDLER_HUMIDITY:
+            return sample.humidity.tenths;
+        default:
+            return 0;
     }
 }
 
-void BlynkManager::fetchManualSwitchState() {
-    std::string response = fetchFromBlynk(2);  // V2: switch (0 = OFF, 1 = ON)
-    ESP_LOGI(TAG, "Received switch response: '%s'", response.c_str());
+void BlynkManager::publishTelemetry(TelemetryChannel& channel, int32_t tenths, bool newSample, uint32_t sampleMs, uint32_t nowMs) {
+    int32_t delta = tenths > channel.lastTenths ? tenths - channel.lastTenths : channel.lastTenths - tenths;
+    bool changed = newSample && (!channel.published || delta > publishDeadbandTenths);
+    bool heartbeatDue = channel.published && (nowMs - channel.lastPublishMs) >= publishHeartbeatMs;
 
-    if (response.empty()) {
-        ESP_LOGE(TAG, "Empty switch state response");
+    if (!changed && !heartbeatDue) {
+        publishStats.suppressed++;
         return;
     }
 
-    bool previousState = manualSwitchOn;
-    manualSwitchOn = (response == "1");
+    if (!changed) {
+        publishStats.heartbeats++;
+    }
+    publishStats.sent++;
 
-    if (previousState != manualSwitchOn) {
-        ESP_LOGI(TAG, "Manual switch changed to: %s", manualSwitchOn ? "ON" : "OFF");
+    bool repeatedSample = channel.published && channel.lastSampleMs == sampleMs;
+    channel.lastTenths = tenths;
+    channel.lastSampleMs = sampleMs;
+    channel.lastPublishMs = nowMs;
+    channel.published = true;
 
-        if (humidifierController) {
-            manualSwitchOn ? humidifierController->turnOn() : humidifierController->turnOff();
-        } else {
-            ESP_LOGW(TAG, "Humidifier controller not set");
+    if (!isLinkUp()) {
+        // The backlog keeps each reading once, at the time it was taken
+        if (repeatedSample) {
+            return;
         }
+        channel.backlog.push(sampleMs, tenths);
+        ESP_LOGI(TAG, "Link down, buffered V%d (%lu waiting)", channel.spec->pin, (unsigned long)channel.backlog.depth());
+        return;
     }
+
+    // "45" rather than "45.0" when there is no fraction
+    char valueStr[PIN_VALUE_LENGTH];
+    size_t length = formatDeci(tenths, valueStr, sizeof(valueStr));
+    if (length == 0) {
+        ESP_LOGW(TAG, "Cannot format V%d value", channel.spec->pin);
+        return;
+    }
+
+    queuePinWrite(channel.spec->pin, std::string_view(valueStr, length));
+    ESP_LOGI(TAG, "Queued V%d: %s for Blynk", channel.spec->pin, valueStr);
+}
+
+void BlynkManager::setPublishPolicy(float deadband, uint32_t heartbeatMs) {
+    publishDeadbandTenths = deadband < 0.0f ? 0 : toTenths(deadband);
+    publishHeartbeatMs = heartbeatMs;
+
+    char deadbandText[DECI_TEXT_SIZE];
+    formatDeci(publishDeadbandTenths, deadbandText, sizeof(deadbandText));
+    ESP_LOGI(TAG, "Publish policy: deadband %s, heartbeat %lu ms", deadbandText, (unsigned long)publishHeartbeatMs);
+}
+
+BlynkManager::PublishStats BlynkManager::getPublishStats() const {
+    return publishStats;
+}
+
+void BlynkManager::queuePinWrite(int virtualPin, std::string_view value) {
+    if (virtualPin < 0 || virtualPin >= MAX_VIRTUAL_PINS) {
+        ESP_LOGW(TAG, "Invalid virtual pin V%d, ignoring write", virtualPin);
+        return;
+    }
+
+    if (value.size() >= PIN_VALUE_LENGTH) {
+        ESP_LOGW(TAG, "Value for V%d too long (%u bytes), ignoring write", virtualPin, (unsigned)value.size());
+        return;
+    }
+
+    if (writeMutex == nullptr || xSemaphoreTake(writeMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    memcpy(pendingWrites[virtualPin], value.data(), value.size());
+    pendingWrites[virtualPin][value.size()] = '\0';
+    pendingWriteMask |= (1UL << virtualPin);
+    xSemaphoreGive(writeMutex);
+}
+
+void BlynkManager::flushPinWrites() {
+    if (writeMutex == nullptr || xSemaphoreTake(writeMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    if (isPushActive()) {
+        // Take the values out so queuePinWrite() never waits behind a stalled send
+        uint32_t mask = pendingWriteMask;
+        for (int pin = 0; pin < MAX_VIRTUAL_PINS; ++pin) {
+            if (mask & (1UL << pin)) {
+                memcpy(pushWrites[pin], pendingWrites[pin], PIN_VALUE_LENGTH);
+            }
+        }
+        pendingWriteMask = 0;
+        xSemaphoreGive(writeMutex);
+
+        // One small frame or message per pin
+        uint32_t failedMask = 0;
+        for (int pin = 0; pin < MAX_VIRTUAL_PINS; ++pin) {
+            uint32_t bit = 1UL << pin;
+            if ((mask & bit) == 0) {
+                continue;
+            }
+            int64_t startUs = esp_timer_get_time();
+            esp_err_t err = pushTransport->virtualWrite(pin, pushWrites[pin]);
+            latencyStats.recordPushWrite(bit, err, static_cast<uint32_t>((esp_timer_get_time() - startUs) / 1000));
+            if (err != ESP_OK) {
+                failedMask |= bit;
+            }
+        }
+
+        // Failed pins go out with the next flush, unless a newer value was queued meanwhile
+        if (failedMask != 0 && xSemaphoreTake(writeMutex, portMAX_DELAY) == pdTRUE) {
+            for (int pin = 0; pin < MAX_VIRTUAL_PINS; ++pin) {
+                uint32_t bit = 1UL << pin;
+                if ((failedMask & bit) && (pendingWriteMask & bit) == 0) {
+                    memcpy(pendingWrites[pin], pushWrites[pin], PIN_VALUE_LENGTH);
+                    pendingWriteMask |= bit;
+                }
+            }
+            xSemaphoreGive(writeMutex);
+        }
+        return;
+    }
+
+    if (writePending) {
+        // Previous batch still queued or in flight, keep collecting
+        xSemaphoreGive(writeMutex);
+        return;
+    }
+
+    uint32_t mask = pendingWriteMask;
+    char query[QUERY_BUFFER_SIZE];
+    size_t length = 0;
+    bool fits = appendFormat(query, sizeof(query), length, "/external/api/batch/update?token=%s", authToken.c_str());
+    for (int pin = 0; fits && pin < MAX_VIRTUAL_PINS; ++pin) {
+        if (mask & (1UL << pin)) {
+            fits = appendFormat(query, sizeof(query), length, "&v%d=%s", pin, pendingWrites[pin]);
+        }
+    }
+    pendingWriteMask = 0;
+    xSemaphoreGive(writeMutex);
+
+    if (mask == 0) {
+        return;
+    }
+
+    if (!fits) {
+        ESP_LOGE(TAG, "Batch update query too long, dropping pin mask 0x%08lx", (unsigned long)mask);
+        return;
+    }
+
+    writePending = true;
+    inFlightWriteMask = mask;
+    if (!requestEngine.submit(BlynkRequestEngine::PRIORITY_NORMAL, std::string_view(query, length), mask,
+                              onBatchUpdateComplete, this)) {
+        // Put the pins back so the values go out with the next flush
+        writePending = false;
+        if (xSemaphoreTake(writeMutex, portMAX_DELAY) == pdTRUE) {
+            pendingWriteMask |= mask;
+            xSemaphoreGive(writeMutex);
+        }
+    }
+}
+
+void BlynkManager::onBatchUpdateComplete(void* context, esp_err_t err, int statusCode, std::string_view response) {
+    BlynkManager* manager = static_cast<BlynkManager*>(context);
+
+    if (err == ESP_OK && statusCode == 200) {
+        ESP_LOGI(TAG, "Batch update sent");
+    } else if (err == ESP_OK) {
+        ESP_LOGW(TAG, "Batch update returned HTTP %d: '%.*s'", statusCode, (int)response.size(), response.data());
+    } else {
+        // Transport failure: the telemetry in this batch goes to the backlog
+        ESP_LOGW(TAG, "Failed to send batch update: %s", esp_err_to_name(err));
+        manager->failedWriteMask |= manager->inFlightWriteMask;
+    }
+    manager->httpLinkUp = (err == ESP_OK);
+    manager->writePending = false;
 }
 
-void BlynkManager::fetchHumidityThreshold() {
-    std::string response = fetchFromBlynk(4);  //V4: HumidityThreshold
-    ESP_LOGI(TAG, "Humidity Threshold response: '%s'", response.c_str());
+bool BlynkManager::isLinkUp() const {
+    return isPushActive() || httpLinkUp;
+}
 
-    if(response.empty()){
-        ESP_LOGE(TAG, "Empty humidity threshold response");
+void BlynkManager::rebufferFailedWrites() {
+    uint32_t failed = failedWriteMask.exchange(0);
+    if (failed == 0) {
         return;
     }
 
-    float humThreshold = std::stof(response);
-    if(humThreshold >= 0.0f && humThreshold <= 100.0f){
-        if(humidifierController){
-            humidifierController->setHumidityThreshold(humThreshold);
-            ESP_LOGI(TAG, "Humidity threshold updated to: %.2f%%", humThreshold);
+    for (TelemetryChannel& channel : telemetryChannels) {
+        if (channel.published && (failed & (1UL << channel.spec->pin))) {
+            channel.backlog.push(channel.lastSampleMs, channel.lastTenths);
         }
-        else{
-            ESP_LOGW(TAG, "Humidifier controller not set");
+    }
+}
+
+void BlynkManager::enableTelemetrySpill() {
+    char nvsNamespace[16];
+    for (TelemetryChannel& channel : telemetryChannels) {
+        snprintf(nvsNamespace, sizeof(nvsNamespace), "blynk_v%d", channel.spec->pin);
+        if (channel.backlog.enableSpill(nvsNamespace) != ESP_OK) {
+            ESP_LOGW(TAG, "V%d backlog stays RAM only", channel.spec->pin);
         }
     }
-    else{
-        ESP_LOGW(TAG, "Invalid humidity threshold value: %.2f, ignoring", humThreshold);
+}
+
+bool BlynkManager::getUnixTimeMs(int64_t& unixMs) {
+    // Anything before 2021 means SNTP has not set the clock yet
+    static constexpr time_t MIN_VALID_TIME = 1609459200;
+
+    struct timeval now;
+    if (gettimeofday(&now, nullptr) != 0 || now.tv_sec < MIN_VALID_TIME) {
+        return false;
     }
+    unixMs = static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_usec / 1000;
+    return true;
 }
 
-void BlynkManager::fetchPixelMode() {
-    //fetch current mode from Blynk 
-    std::string response  = fetchFromBlynk(5);
-    ESP_LOGI(TAG, "Pixel mode: '%s'", response.c_str());
+void BlynkManager::drainBacklog(uint32_t nowMs) {
+    int state = drainState;
+    if (state == DRAIN_OK || state == DRAIN_FAILED) {
+        finishDrain();
+    }
+
+    bool backlogged = false;
+    for (const TelemetryChannel& channel : telemetryChannels) {
+        backlogged = backlogged || !channel.backlog.empty();
+    }
+    if (backlogged && isLinkUp()) {
+        drainActiveMs += nowMs - lastBacklogCheckMs;
+    }
+    lastBacklogCheckMs = nowMs;
+
+    // One upload at a time, low priority and spaced out, so control reads and
+    // live telemetry keep the link while the backlog catches up
+    if (!backlogged || drainState != DRAIN_IDLE || !isLinkUp() || nowMs - lastDrainMs < DRAIN_INTERVAL_MS) {
+        return;
+    }
+
+    int64_t unixNowMs = 0;
+    if (!getUnixTimeMs(unixNowMs)) {
+        ESP_LOGW(TAG, "Clock not synced, holding telemetry backlog");
+        return;
+    }
+
+    // Oldest sample first across channels
+    TelemetryBuffer::Sample samples[DRAIN_BATCH];
+    size_t channelIndex = TELEMETRY_PIN_COUNT;
+    uint32_t oldestAge = 0;
+    for (size_t i = 0; i < TELEMETRY_PIN_COUNT; ++i) {
+        uint32_t firstSeq = 0;
+        if (telemetryChannels[i].backlog.peek(samples, 1, firstSeq) == 1
+            && (channelIndex == TELEMETRY_PIN_COUNT || nowMs - samples[0].uptimeMs > oldestAge)) {
+            channelIndex = i;
+            oldestAge = nowMs - samples[0].uptimeMs;
+        }
+    }
+    if (channelIndex == TELEMETRY_PIN_COUNT) {
+        return;
+    }
+
+    TelemetryChannel& channel = telemetryChannels[channelIndex];
+    uint32_t firstSeq = 0;
+    size_t count = channel.backlog.peek(samples, DRAIN_BATCH, firstSeq);
 
-    if(response.empty()){
-        ESP_LOGE(TAG, "Empty Pixel mode response");
+    // Body is [[unixMs,value],...] with each sample's original time
+    size_t bodyLength = 0;
+    bool fits = appendFormat(drainBody, sizeof(drainBody), bodyLength, "[");
+    for (size_t i = 0; fits && i < count; ++i) {
+        int64_t sampleMs = unixNowMs - (nowMs - samples[i].uptimeMs);
+        char valueText[DECI_TEXT_SIZE];
+        formatDeci(samples[i].tenths, valueText, sizeof(valueText));
+        fits = appendFormat(drainBody, sizeof(drainBody), bodyLength, "%s[%lld,%s]",
+                            i == 0 ? "" : ",", (long long)sampleMs, valueText);
+    }
+    fits = fits && appendFormat(drainBody, sizeof(drainBody), bodyLength, "]");
+
+    char query[QUERY_BUFFER_SIZE];
+    size_t queryLength = 0;
+    fits = fits && appendFormat(query, sizeof(query), queryLength, "/external/api/batch/update?token=%s&pin=V%d",
+                                authToken.c_str(), channel.spec->pin);
+    if (!fits) {
+        ESP_LOGE(TAG, "Backlog upload for V%d does not fit", channel.spec->pin);
         return;
     }
 
-    int mode = std::stoi(response);
-    ESP_LOGI(TAG, "Fetched pixel mode:%d", mode);
+    drainChannel = channelIndex;
+    drainEndSeq = firstSeq + count;
+    drainSampleCount = count;
+    lastDrainMs = nowMs;
+    drainState = DRAIN_IN_FLIGHT;
+    if (!requestEngine.submit(BlynkRequestEngine::PRIORITY_LOW, std::string_view(query, queryLength),
+                              1UL << channel.spec->pin, onDrainComplete, this, std::string_view(drainBody, bodyLength))) {
+        drainState = DRAIN_IDLE;
+    }
+}
+
+void BlynkManager::finishDrain() {
+    TelemetryChannel& channel = telemetryChannels[drainChannel];
+
+    if (drainState == DRAIN_OK) {
+        channel.backlog.discardBefore(drainEndSeq);
+        drainedSamples += drainSampleCount;
+        ESP_LOGI(TAG, "Uploaded %lu backlog samples for V%d, %lu left", (unsigned long)drainSampleCount,
+                 channel.spec->pin, (unsigned long)channel.backlog.depth());
+    }
+    drainState = DRAIN_IDLE;
+}
+
+void BlynkManager::onDrainComplete(void* context, esp_err_t err, int statusCode, std::string_view response) {
+    BlynkManager* manager = static_cast<BlynkManager*>(context);
 
-    //update 
-    pixelManager->updateModeFromBlynk(mode);
+    if (err == ESP_OK && statusCode == 200) {
+        manager->drainState = DRAIN_OK;
+    } else {
+        if (err == ESP_OK) {
+            ESP_LOGW(TAG, "Backlog upload returned HTTP %d: '%.*s'", statusCode, (int)response.size(), response.data());
+        } else {
+            ESP_LOGW(TAG, "Backlog upload failed: %s", esp_err_to_name(err));
+        }
+        manager->drainState = DRAIN_FAILED;
+    }
+    manager->httpLinkUp = (err == ESP_OK);
 }
 
-void BlynkManager::fetchPixelBrightness() {
-    //Fetch brightness level from Blynk
-    std::string response = fetchFromBlynk(6);
-    ESP_LOGI(TAG, "Pixel brightness response: '%s'", response.c_str());
+BlynkManager::BacklogStats BlynkManager::getBacklogStats() const {
+    BacklogStats stats = {};
+    for (const TelemetryChannel& channel : telemetryChannels) {
+        TelemetryBuffer::Stats bufferStats = channel.backlog.getStats();
+        stats.depth += bufferStats.depth;
+        stats.dropped += bufferStats.dropped;
+        stats.spilled += bufferStats.spilled;
+    }
+    stats.drained = drainedSamples;
+    stats.drainPerMinute = drainActiveMs > 0 ? static_cast<uint32_t>(static_cast<uint64_t>(drainedSamples) * 60000 / drainActiveMs) : 0;
+    return stats;
+}
 
-    if(response.empty()) {
-        ESP_LOGE(TAG, "Empty pixel brightness response");
+void BlynkManager::fetchPins(VirtualPinSpec::Group group) {
+    char query[QUERY_BUFFER_SIZE];
+    size_t queryLength = buildPinQuery(query, sizeof(query), group);
+    if (queryLength == 0) {
         return;
     }
 
-    uint8_t brightness = std::stoi(response);
+    char response[SYNC_RESPONSE_SIZE];
+    size_t length = 0;
+    int statusCode = 0;
+    BlynkHttpSession::Timing timing = {};
+    esp_err_t err = httpSession.get(query, response, sizeof(response), &length, &statusCode, &timing);
+    latencyStats.recordRequest(BlynkPinRegistry::groupMask(group), err, statusCode, timing);
+
+    std::string_view values[SNAPSHOT_SLOTS];
+    if (readSnapshot(err, statusCode, std::string_view(response, length), values)) {
+        dispatchGroup(group, values);
+    }
+}
+
+void BlynkManager::fetchAllPins(bool includePixels) {
+    char query[QUERY_BUFFER_SIZE];
+
+    // Control pins go ahead of the cosmetic pixel pins so a switch change
+    // never waits behind LED colour reads
+    static constexpr struct {
+        VirtualPinSpec::Group group;
+        BlynkRequestEngine::Priority priority;
+        BlynkRequestEngine::Completion completion;
+    } polledGroups[] = {
+        { VirtualPinSpec::GROUP_CONTROL, BlynkRequestEngine::PRIORITY_HIGH, onControlSnapshot },
+        { VirtualPinSpec::GROUP_PIXEL,   BlynkRequestEngine::PRIORITY_LOW,  onPixelSnapshot },
+    };
 
-    if(brightness >= 0 && brightness <= 100) {
-        ESP_LOGI(TAG, "Fetched pixel brightness: %d", brightness);
+    for (const auto& polled : polledGroups) {
+        std::atomic<bool>& pending = groupReadPending[polled.group];
+        if (pending || (polled.group == VirtualPinSpec::GROUP_PIXEL && !includePixels)) {
+            continue;
+        }
 
-        //update brightness in PixelManager
-        if(pixelManager) {
-            pixelManager->setBrightness(brightness);
+        pending = true;
+        size_t length = buildPinQuery(query, sizeof(query), polled.group);
+        if (length == 0 || !requestEngine.submit(polled.priority, std::string_view(query, length),
+                                                   BlynkPinRegistry::groupMask(polled.group), polled.completion, this)) {
+            pending = false;
         }
-        else{
-            ESP_LOGW(TAG, "PixelManager not set");
+    }
+}
+
+size_t BlynkManager::buildPinQuery(char* buffer, size_t size, VirtualPinSpec::Group group) const {
+    // One request for every downlink pin in the group, e.g. get?token=..&v3&v2&v4
+    size_t length = 0;
+    bool fits = appendFormat(buffer, size, length, "/external/api/get?token=%s", authToken.c_str());
+    for (const VirtualPinSpec& spec : BlynkPinRegistry::PINS) {
+        if (fits && spec.group == group && spec.direction == VirtualPinSpec::DOWNLINK) {
+            fits = appendFormat(buffer, size, length, "&v%d", spec.pin);
         }
     }
-    else{
-        ESP_LOGW(TAG, "Invalid brightness value: %d, ignoring", brightness);
+
+    if (!fits) {
+        ESP_LOGE(TAG, "Pin query for group %d too long", group);
+        return 0;
+    }
+    return length;
+}
+
+bool BlynkManager::readSnapshot(esp_err_t err, int statusCode, std::string_view response, std::string_view* values) {
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to fetch pin snapshot: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    if (statusCode != 200) {
+        ESP_LOGW(TAG, "Pin snapshot returned HTTP %d: '%.*s'", statusCode, (int)response.size(), response.data());
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Pin snapshot: %.*s", (int)response.size(), response.data());
+
+    if (!parsePinSnapshot(response, values, SNAPSHOT_SLOTS)) {
+        ESP_LOGE(TAG, "Malformed pin snapshot response");
+        return false;
+    }
+    return true;
+}
+
+void BlynkManager::completeGroupRead(VirtualPinSpec::Group group, esp_err_t err, int statusCode, std::string_view response) {
+    std::string_view values[SNAPSHOT_SLOTS];
+
+    httpLinkUp = (err == ESP_OK);
+    if (readSnapshot(err, statusCode, response, values)) {
+        dispatchGroup(group, values);
     }
+
+    groupReadPending[group] = false;
 }
 
-void BlynkManager::fetchPixelColor() {
-    //Fetch color from Blynk
-    std::string r = fetchFromBlynk(7);
-    std::string g = fetchFromBlynk(8);
-    std::string b = fetchFromBlynk(9);
+void BlynkManager::onControlSnapshot(void* context, esp_err_t err, int statusCode, std::string_view response) {
+    static_cast<BlynkManager*>(context)->completeGroupRead(VirtualPinSpec::GROUP_CONTROL, err, statusCode, response);
+}
 
-    if(r.empty() || g.empty() || b.empty()){
-        ESP_LOGE(TAG, "Empty color responses");
+void BlynkManager::onPixelSnapshot(void* context, esp_err_t err, int statusCode, std::string_view response) {
+    static_cast<BlynkManager*>(context)->completeGroupRead(VirtualPinSpec::GROUP_PIXEL, err, statusCode, response);
+}
+
+bool BlynkManager::parsePinValue(const VirtualPinSpec& spec, std::string_view text, float& value) {
+    if (text.empty()) {
+        ESP_LOGE(TAG, "Empty V%d value", spec.pin);
+        return false;
+    }
+
+    bool parsed;
+    if (spec.type == VirtualPinSpec::TYPE_FLOAT) {
+        parsed = parseFloat(text, value);
+    } else {
+        int intValue = 0;
+        parsed = parseInt(text, intValue);
+        value = static_cast<float>(intValue);
+    }
+
+    if (!parsed || value < spec.minValue || value > spec.maxValue) {
+        ESP_LOGW(TAG, "Invalid V%d value '%.*s', ignoring", spec.pin, (int)text.size(), text.data());
+        return false;
+    }
+    return true;
+}
+
+void BlynkManager::dispatchGroup(VirtualPinSpec::Group group, const std::string_view* values) {
+    int colour[3] = { -1, -1, -1 };
+    uint16_t changed = 0;
+
+    if (configMutex == nullptr || xSemaphoreTake(configMutex, portMAX_DELAY) != pdTRUE) {
         return;
     }
 
-    uint8_t red = std::stoi(r);
-    uint8_t green = std::stoi(g);
-    uint8_t blue = std::stoi(b);
+    for (const VirtualPinSpec& spec : BlynkPinRegistry::PINS) {
+        if (spec.group != group || spec.direction != VirtualPinSpec::DOWNLINK) {
+            continue;
+        }
 
-    if(red >= 0 && red <= 255 
-        && green >= 0 && green <= 255
-        && blue >= 0 && blue <= 255){
-        ESP_LOGI(TAG, "Fetched RGB values: %d, %d, %d", red, green, blue);
-        if(pixelManager) {
-            pixelManager->setColourFromBlynk(red, green, blue);
+        float value = 0.0f;
+        if (parsePinValue(spec, values[spec.pin], value)) {
+            noteRemoteValue(spec, value);
+            changed |= dispatchPinValue(spec, value, colour);
         }
-        else {
-            ESP_LOGW(TAG, "PixelManager not set");
+    }
+
+    if (colour[0] >= 0 || colour[1] >= 0 || colour[2] >= 0) {
+        if (colour[0] < 0 || colour[1] < 0 || colour[2] < 0) {
+            ESP_LOGW(TAG, "Incomplete colour values: %d %d %d, ignoring", colour[0], colour[1], colour[2]);
+        } else {
+            changed |= applyColour(colour);
         }
     }
-    else{
-        ESP_LOGW(TAG, "Invalid color values: %d %d %d, ignoring", red, green, blue);
+
+    // The whole group becomes visible at once
+    publishConfig(changed);
+}
+
+// Caller holds configMutex
+uint16_t BlynkManager::applyColour(const int* colour) {
+    if (workingConfig.has(ControlConfig::FIELD_COLOUR) && workingConfig.red == colour[0]
+        && workingConfig.green == colour[1] && workingConfig.blue == colour[2]) {
+        return 0;
     }
+
+    ESP_LOGI(TAG, "Fetched RGB values: %d, %d, %d", colour[0], colour[1], colour[2]);
+    workingConfig.red = static_cast<uint8_t>(colour[0]);
+    workingConfig.green = static_cast<uint8_t>(colour[1]);
+    workingConfig.blue = static_cast<uint8_t>(colour[2]);
+    workingConfig.validFields |= ControlConfig::FIELD_COLOUR;
+    return ControlConfig::FIELD_COLOUR;
 }
 
-std::string BlynkManager::fetchFromBlynk(int virtualPin) {
-    std::string url = "http://blynk.cloud/external/api/get?token=" + authToken + "&v" + std::to_string(virtualPin);
-    ESP_LOGI(TAG, "Fetching from Blynk URL: %s", url.c_str());
+// Caller holds configMutex, which is released here. Readers see the new
+// snapshot before the controller is woken to act on it.
+void BlynkManager::publishConfig(uint16_t changedFields) {
+    if (changedFields != 0) {
+        sharedConfig.publish(workingConfig);
+    }
+    xSemaphoreGive(configMutex);
 
-    esp_http_client_config_t config = {};
-    config.url = url.c_str();
-    config.method = HTTP_METHOD_GET;
-    config.timeout_ms = 5000;
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    std::string response;
+    if (changedFields & CONTROLLER_FIELDS) {
+        notifyController();
+    }
+}
+
+bool BlynkManager::isPushActive() const {
+    return pushTransport && pushTransport->isConnected();
+}
+
+void BlynkManager::onPushedPinWrite(void* context, int pin, std::string_view value) {
+    BlynkManager* manager = static_cast<BlynkManager*>(context);
+    const VirtualPinSpec* spec = BlynkPinRegistry::find(pin);
+    if (spec == nullptr || spec->direction != VirtualPinSpec::DOWNLINK) {
+        ESP_LOGW(TAG, "Ignoring pushed write to V%d", pin);
+        return;
+    }
 
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to init HTTP client");
-        return response;
+    float parsed = 0.0f;
+    if (!parsePinValue(*spec, value, parsed)) {
+        return;
     }
-    
-    // Open connection and send request
-    esp_err_t err = esp_http_client_open(client, 0);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open HTTP connection: %s", esp_err_to_name(err));
-        esp_http_client_cleanup(client);
-        return response;
-    }
-    
-    // Get response content length
-    int content_length = esp_http_client_fetch_headers(client); 
-    if (content_length > 0) {
-        // Allocate buffer
-        char* buffer = new char[content_length + 1];
-        // Read data in chunks
-        int total_read = 0;
-        int remaining = content_length;
-        while (remaining > 0) {
-            int read_len = esp_http_client_read(client, buffer + total_read, remaining);
-            if (read_len <= 0) {
-                break;  // Error or end of data
+
+    if (manager->configMutex == nullptr || xSemaphoreTake(manager->configMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    manager->noteRemoteValue(*spec, parsed);
+    uint16_t changed = manager->dispatchPinValue(*spec, parsed, manager->pushedColour);
+
+    // Colour pins arrive one at a time; apply once all three are known
+    int* colour = manager->pushedColour;
+    bool colourPin = spec->handler == VirtualPinSpec::HANDLER_PIXEL_RED || spec->handler == VirtualPinSpec::HANDLER_PIXEL_GREEN
+                     || spec->handler == VirtualPinSpec::HANDLER_PIXEL_BLUE;
+    if (colourPin && colour[0] >= 0 && colour[1] >= 0 && colour[2] >= 0) {
+        changed |= manager->applyColour(colour);
+    }
+
+    manager->publishConfig(changed);
+}
+
+void BlynkManager::onPushConnected(void* context) {
+    BlynkManager* manager = static_cast<BlynkManager*>(context);
+
+    // Ask for every downlink pin, in table order, so state matches the app
+    int pins[BlynkPinRegistry::PIN_COUNT];
+    size_t count = 0;
+    for (const VirtualPinSpec& spec : BlynkPinRegistry::PINS) {
+        if (spec.direction == VirtualPinSpec::DOWNLINK) {
+            pins[count++] = spec.pin;
+        }
+    }
+
+    if (manager->pushTransport->syncVirtual(pins, count) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to request pin sync over %s", manager->pushTransport->getName());
+    }
+}
+
+void BlynkManager::noteRemoteValue(const VirtualPinSpec& spec, float value) {
+    uint32_t bit = 1UL << spec.pin;
+    bool known = (remoteValueMask & bit) != 0;
+
+    if (known && remoteValues[spec.pin] != value) {
+        ESP_LOGI(TAG, "Remote change on V%d, entering burst polling", spec.pin);
+        if (!remoteChanged.exchange(true) && monitorTaskHandle != nullptr) {
+            xTaskNotify(monitorTaskHandle, NOTIFY_REMOTE_CHANGE, eSetBits);
+        }
+    }
+
+    remoteValues[spec.pin] = value;
+    remoteValueMask |= bit;
+}
+
+// Without a controller yet (boot-time fetch) it reads the state when it starts
+void BlynkManager::notifyController() {
+    if (humidifierController) {
+        humidifierController->notifyControlChanged();
+    }
+}
+
+// Runs on the requesting task with the HTTP session locked; only notifies
+void BlynkManager::onBreakerStateChanged(void* context, CircuitBreaker::State state) {
+    BlynkManager* manager = static_cast<BlynkManager*>(context);
+    if (manager->humidifierController) {
+        manager->humidifierController->notifyCloudStateChanged();
+    }
+}
+
+// Caller holds configMutex; returns the ControlConfig fields that changed
+uint16_t BlynkManager::dispatchPinValue(const VirtualPinSpec& spec, float value, int* colour) {
+    ControlConfig& config = workingConfig;
+
+    switch (spec.handler) {
+        case VirtualPinSpec::HANDLER_CONTROL_MODE: {
+            // 0 = Auto, 1 = Manual
+            bool autoMode = (value == 0.0f);
+            if (config.has(ControlConfig::FIELD_MODE) && config.autoMode == autoMode) {
+                return 0;
             }
-            total_read += read_len;
-            remaining -= read_len;
-        }
-        if (total_read > 0) {
-            buffer[total_read] = '\0';
-            response = std::string(buffer, total_read);
-            // Clean any whitespace or quotes
-            if (!response.empty()) {
-                if (response.front() == '"' && response.back() == '"') {
-                    response = response.substr(1, response.length() - 2);
-                }
+            if (config.autoMode != autoMode) {
+                ESP_LOGI(TAG, "Control mode changed to: %s", autoMode ? "Auto" : "Manual");
+            }
+            config.autoMode = autoMode;
+            config.validFields |= ControlConfig::FIELD_MODE;
+            return ControlConfig::FIELD_MODE;
+        }
+
+        case VirtualPinSpec::HANDLER_MANUAL_SWITCH: {
+            // Kept in auto mode too (the controller ignores it there): a pushed
+            // V2 arrives only once, and must be current when V3 goes to manual
+            bool switchOn = (value != 0.0f);
+            if (config.has(ControlConfig::FIELD_SWITCH) && config.manualSwitchOn == switchOn) {
+                return 0;
+            }
+            if (config.manualSwitchOn != switchOn) {
+                // The controller task owns the GPIO and applies the switch
+                ESP_LOGI(TAG, "Manual switch changed to: %s", switchOn ? "ON" : "OFF");
+            }
+            config.manualSwitchOn = switchOn;
+            config.validFields |= ControlConfig::FIELD_SWITCH;
+            return ControlConfig::FIELD_SWITCH;
+        }
+
+        case VirtualPinSpec::HANDLER_HUMIDITY_THRESHOLD:
+            if (config.has(ControlConfig::FIELD_THRESHOLD) && config.humidityThreshold == value) {
+                return 0;
+            }
+            config.humidityThreshold = value;
+            config.validFields |= ControlConfig::FIELD_THRESHOLD;
+            return ControlConfig::FIELD_THRESHOLD;
+
+        case VirtualPinSpec::HANDLER_PIXEL_MODE: {
+            uint8_t mode = static_cast<uint8_t>(value);
+            if (config.has(ControlConfig::FIELD_PIXEL_MODE) && config.pixelMode == mode) {
+                return 0;
+            }
+            config.pixelMode = mode;
+            config.validFields |= ControlConfig::FIELD_PIXEL_MODE;
+            return ControlConfig::FIELD_PIXEL_MODE;
+        }
+
+        case VirtualPinSpec::HANDLER_PIXEL_BRIGHTNESS: {
+            uint8_t brightness = static_cast<uint8_t>(value);
+            if (config.has(ControlConfig::FIELD_BRIGHTNESS) && config.pixelBrightness == brightness) {
+                return 0;
+            }
+            config.pixelBrightness = brightness;
+            config.validFields |= ControlConfig::FIELD_BRIGHTNESS;
+            return ControlConfig::FIELD_BRIGHTNESS;
+        }
+
+        case VirtualPinSpec::HANDLER_PIXEL_RED:
+            colour[0] = static_cast<int>(value);
+            break;
+
+        case VirtualPinSpec::HANDLER_PIXEL_GREEN:
+            colour[1] = static_cast<int>(value);
+            break;
+
+        case VirtualPinSpec::HANDLER_PIXEL_BLUE:
+            colour[2] = static_cast<int>(value);
+            break;
+
+        case VirtualPinSpec::HANDLER_TEMPERATURE:
+        case VirtualPinSpec::HANDLER_HUMIDITY:
+            // Uplink only, never dispatched
+            break;
+    }
+    return 0;
+}
+
+bool BlynkManager::parsePinSnapshot(std::string_view json, std::string_view* values, int maxPins) {
+    // Expects a flat object such as {"v2":1,"v3":"0","v4":"55.5"}; the values
+    // returned are views into json
+    size_t pos = json.find('{');
+    if (pos == std::string_view::npos) {
+        return false;
+    }
+    ++pos;
+
+    while (pos < json.size()) {
+        size_t keyStart = json.find('"', pos);
+        if (keyStart == std::string_view::npos) {
+            break;
+        }
+        size_t keyEnd = json.find('"', keyStart + 1);
+        if (keyEnd == std::string_view::npos) {
+            return false;
+        }
+        size_t colon = json.find(':', keyEnd);
+        if (colon == std::string_view::npos) {
+            return false;
+        }
+
+        size_t valueStart = colon + 1;
+        while (valueStart < json.size() && json[valueStart] == ' ') {
+            ++valueStart;
+        }
+
+        size_t valueEnd;
+        std::string_view value;
+        if (valueStart < json.size() && json[valueStart] == '"') {
+            valueEnd = json.find('"', valueStart + 1);
+            if (valueEnd == std::string_view::npos) {
+                return false;
             }
+            value = json.substr(valueStart + 1, valueEnd - valueStart - 1);
+            ++valueEnd;
         } else {
-            ESP_LOGW(TAG, "Failed to read data: %d/%d bytes read", total_read, content_length);
+            valueEnd = json.find_first_of(",}", valueStart);
+            if (valueEnd == std::string_view::npos) {
+                return false;
+            }
+            value = json.substr(valueStart, valueEnd - valueStart);
+            while (!value.empty() && value.back() == ' ') {
+                value.remove_suffix(1);
+            }
         }
-        delete[] buffer;
-    } else {
-        ESP_LOGW(TAG, "Invalid content length: %d", content_length);
+
+        // Keys are "v<pin>" (case-insensitive)
+        std::string_view key = json.substr(keyStart + 1, keyEnd - keyStart - 1);
+        int pin = -1;
+        if (key.size() >= 2 && (key[0] == 'v' || key[0] == 'V') && parseInt(key.substr(1), pin)
+            && pin >= 0 && pin < maxPins) {
+            values[pin] = value;
+        }
+
+        pos = valueEnd;
     }
-    
-    // Close connection
-    esp_http_client_close(client);
-    esp_http_client_cleanup(client);
-    
-    return response;
+
+    return true;
 }
 
-void BlynkManager::sendToBlynk(int virtualPin, const std::string& value) {
-    std::string url = baseURL;
-    if (!url.empty() && url.back() != '/') {
-        url += '/';
+void BlynkManager::logCycleStats() {
+    if (pushTransport) {
+        BlynkPushTransport::Stats pushStats = pushTransport->getStats();
+        ESP_LOGI(TAG, "%s link %s: %lu connects, %lu login failures, %lu redirects, %lu sent (%lu bytes), %lu received, round trip %lu ms",
+                 pushTransport->getName(), pushTransport->isConnected() ? "up" : "down",
+                 (unsigned long)pushStats.connects, (unsigned long)pushStats.loginFailures,
+                 (unsigned long)pushStats.redirects, (unsigned long)pushStats.framesSent,
+                 (unsigned long)pushStats.bytesSent, (unsigned long)pushStats.framesReceived,
+                 (unsigned long)pushStats.lastRoundTripMs);
     }
 
-    url += "external/api/update?token=" + authToken + "&v" + std::to_string(virtualPin) + "=" + value;
-    ESP_LOGI(TAG, "Sending to Blynk URL: %s", url.c_str());
+    BacklogStats backlog = getBacklogStats();
+    if (backlog.depth > 0 || backlog.dropped > 0) {
+        ESP_LOGI(TAG, "Backlog: %lu waiting, %lu dropped, %lu spilled, %lu drained (%lu/min)",
+                 (unsigned long)backlog.depth, (unsigned long)backlog.dropped, (unsigned long)backlog.spilled,
+                 (unsigned long)backlog.drained, (unsigned long)backlog.drainPerMinute);
+    }
 
-    esp_http_client_config_t config = {};
-    config.url = url.c_str();
-    config.method = HTTP_METHOD_GET;
-    config.timeout_ms = 5000;
+    BlynkHttpSession::Stats stats = httpSession.takeCycleStats();
+    lastCycleHeapAllocations = HeapMonitor::takeAllocationCount();
+    ESP_LOGI(TAG, "Cycle HTTP: %lu requests, %lu new connections, %lu reused, %lu reconnects, %lu failures, %lu rejected, %lu heap allocs",
+             (unsigned long)stats.requests, (unsigned long)stats.newConnections,
+             (unsigned long)stats.reusedConnections, (unsigned long)stats.reconnects,
+             (unsigned long)stats.failures, (unsigned long)stats.rejected, (unsigned long)lastCycleHeapAllocations);
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to init HTTP client");
-        return;
+    BlynkHttpSession::TlsStats tls = httpSession.getTlsStats();
+    const TlsHandshakeStats::Stats& handshakes = tls.handshakes;
+    if (tls.enabled && handshakes.handshakes > 0) {
+        // Resumed/full is estimated from the handshake time (see TlsHandshakeStats)
+        ESP_LOGI(TAG, "TLS: %lu handshakes for %lu requests, %lu with a saved session (est. %lu resumed, %lu full), last %lu ms (est. %s), avg full %lu ms, avg est. resumed %lu ms, max %lu ms",
+                 (unsigned long)handshakes.handshakes, (unsigned long)tls.requests,
+                 (unsigned long)handshakes.sessionOffers, (unsigned long)handshakes.estimatedResumed,
+                 (unsigned long)handshakes.estimatedFull, (unsigned long)handshakes.lastHandshakeMs,
+                 handshakes.lastEstimatedResumed ? "resumed" : "full", (unsigned long)handshakes.averageFullMs,
+                 (unsigned long)handshakes.averageResumedMs, (unsigned long)handshakes.maxHandshakeMs);
     }
 
-    esp_err_t err = esp_http_client_perform(client);
-    if (err == ESP_OK) {
-        int status_code = esp_http_client_get_status_code(client);
-        ESP_LOGI(TAG, "Sent to V%d: %s (HTTP %d)", virtualPin, value.c_str(), status_code);
-    } else {
-        ESP_LOGW(TAG, "Failed to send to V%d: %s", virtualPin, esp_err_to_name(err));
+    DnsCache* dnsCache = servers.getDnsCache(activeServer);
+    DnsCache::Stats dns = dnsCache->getStats();
+    ESP_LOGI(TAG, "DNS %s: %lu hits, %lu misses, %lu resolutions (%lu failed), latency last %lu / avg %lu / max %lu ms",
+             dnsCache->getHost().c_str(), (unsigned long)dns.hits, (unsigned long)dns.misses,
+             (unsigned long)dns.resolutions, (unsigned long)dns.failures, (unsigned long)dns.lastLatencyMs,
+             (unsigned long)dns.averageLatencyMs, (unsigned long)dns.maxLatencyMs);
+
+    static const char* const breakerNames[] = { "closed", "open", "half-open" };
+    CircuitBreaker::State cloudState = getCloudState();
+    if (cloudState != CircuitBreaker::CLOSED) {
+        ESP_LOGW(TAG, "Blynk circuit %s, requests fail fast", breakerNames[cloudState]);
+    }
+
+    uint32_t nowMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    if (nowMs - lastLatencyDumpMs >= LATENCY_DUMP_INTERVAL_MS) {
+        lastLatencyDumpMs = nowMs;
+        latencyStats.dump();
     }
+}
+
+void BlynkManager::setPollPolicy(uint32_t burstIntervalMs, uint32_t ceilingIntervalMs, uint32_t burstCycles) {
+    pollScheduler.setPolicy(burstIntervalMs, ceilingIntervalMs, burstCycles);
+    ESP_LOGI(TAG, "Poll policy: burst %lu ms for %lu polls, ceiling %lu ms",
+             (unsigned long)burstIntervalMs, (unsigned long)burstCycles, (unsigned long)ceilingIntervalMs);
+}
+
+AdaptivePollScheduler::Stats BlynkManager::getPollStats() const {
+    return pollScheduler.getStats();
+}
+
+uint32_t BlynkManager::getLastCycleHeapAllocations() const {
+    return lastCycleHeapAllocations;
+}
 
-    esp_http_client_cleanup(client);
+void BlynkManager::dumpLatencyStats() const {
+    latencyStats.dump();
+}
+
+const BlynkLatencyStats& BlynkManager::getLatencyStats() const {
+    return latencyStats;
+}
+
+CircuitBreaker::State BlynkManager::getCloudState() const {
+    return httpSession.getBreakerState();
+}
+
+bool BlynkManager::isCloudReachable() const {
+    return isPushActive() || getCloudState() == CircuitBreaker::CLOSED;
 }
 
 bool BlynkManager::isAutoMode() const {
-    return autoMode;
+    ControlConfig config;
+    sharedConfig.read(config);
+    return config.autoMode;
 }
 
 bool BlynkManager::isManualSwitchOn() const {
-    return manualSwitchOn;
+    ControlConfig config;
+    sharedConfig.read(config);
+    return config.manualSwitchOn;
+}
+
+const SharedControlConfig& BlynkManager::getControlConfig() const {
+    return sharedConfig;
 }
 
 void BlynkManager::setHumidifierController(HumidifierController* controller) {
     this->humidifierController = controller;
 }
-
@@ -1,39 +1,259 @@
 // BlynkManager.hpp
+#pragma once
 
-
+#include "BlynkHttpSession.hpp"
+#include "BlynkRequestEngine.hpp"
+#include "BlynkLatencyStats.hpp"
+#include "BlynkPinRegistry.hpp"
+#include "ControlConfig.hpp"
+#include "BlynkServerSelector.hpp"
+#include "AdaptivePollScheduler.hpp"
+#include "BlynkTcpTransport.hpp"
+#include "BlynkMqttTransport.hpp"
+#include "TelemetryBuffer.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include <string>
+#include <string_view>
+#include <atomic>
+#include <memory>
 
-class DHTSensor;
+class ClimateSource;
+struct ClimateSample;
 class HumidifierController;
 class PixelManager;
 
 class BlynkManager {
 public:
-    BlynkManager(const std::string& authToken, const std::string& baseURL, DHTSensor* dhtSensor, HumidifierController* humidifierController, PixelManager* pixelManager);
+    // Telemetry publish counters since boot
+    struct PublishStats {
+        uint32_t sent;
+        uint32_t suppressed;
+        uint32_t heartbeats;
+        uint32_t staleCycles;  // no sensor sample fresh enough to publish
+    };
+
+    // Offline telemetry backlog, summed over all telemetry pins
+    struct BacklogStats {
+        uint32_t depth;
+        uint32_t dropped;
+        uint32_t spilled;
+        uint32_t drained;
+        uint32_t drainPerMinute;  // samples uploaded per minute of draining
+    };
+
+    BlynkManager(const std::string& authToken, const std::string& baseURL, ClimateSource* climateSource, HumidifierController* humidifierController, PixelManager* pixelManager);
     void start();
 
+    // Switches from HTTP polling to the persistent TCP hardware protocol, where
+    // the server pushes app writes instantly. Call before start(); HTTP is still
+    // used for any cycle in which the push link is down.
+    void enableHardwareProtocol(const std::string& host, uint16_t port);
+    // Same, over Blynk's MQTT API (e.g. "mqtt://blynk.cloud:1883"). QoS 1
+    // makes the broker acknowledge every publish.
+    void enableMqtt(const std::string& brokerUri, int qos);
+
+    // Extra regional base URLs next to the constructor's one. Traffic goes to
+    // the healthy server with the lowest round-trip time, re-measured
+    // periodically, and fails over when the active one stops answering.
+    // Call before start().
+    void addCandidateServer(const std::string& baseURL);
+
+    // CA or self-signed certificate for https:// servers that are not covered
+    // by the IDF certificate bundle (e.g. a local test server)
+    void setServerCertificate(const char* pem);
+
     bool isAutoMode() const;
     bool isManualSwitchOn() const;
+    // Mode, switch, threshold and pixel settings as one consistent snapshot;
+    // readers compare getVersion() to skip work when nothing changed
+    const SharedControlConfig& getControlConfig() const;
+
+    // Circuit breaker state of the HTTP client; while OPEN requests fail
+    // instantly and app values (mode, switch) may be stale. Changes wake the
+    // humidifier controller.
+    CircuitBreaker::State getCloudState() const;
+    bool isCloudReachable() const;
     void setHumidifierController(HumidifierController* controller);
     void setPixelManager(PixelManager* manager);
-    void fetchControlMode();
-    void fetchManualSwitchState();
-    void fetchHumidityThreshold();
-    void fetchPixelMode();
-    void fetchPixelBrightness();
-    void fetchPixelColor();
+    // Synchronously reads every downlink pin of a group in one request and
+    // dispatches the values (used at boot before the poll loop runs)
+    void fetchPins(VirtualPinSpec::Group group);
+    // Queues batched reads of the control group (high priority) and, unless
+    // skipped, the pixel group (low priority); values are dispatched on completion
+    void fetchAllPins(bool includePixels = true);
+
+    // Write-combining upload: values are collected during a cycle and sent
+    // together in one batch/update request by flushPinWrites()
+    void queuePinWrite(int virtualPin, std::string_view value);
+    void flushPinWrites();
+
+    // Telemetry is only published when it moves more than `deadband` from the
+    // last published value, or when `heartbeatMs` has passed since then.
+    // Values are compared in integer tenths; the deadband is rounded to them.
+    void setPublishPolicy(float deadband, uint32_t heartbeatMs);
+    PublishStats getPublishStats() const;
+
+    // While Blynk is unreachable, telemetry is kept in a per-pin backlog and
+    // uploaded with its original timestamps once the link is back. Spill lets
+    // the backlog overflow into NVS instead of dropping the oldest samples
+    // (call after nvs_flash_init()).
+    void enableTelemetrySpill();
+    BacklogStats getBacklogStats() const;
+
+    // Poll interval drops to `burstIntervalMs` for `burstCycles` polls after a
+    // remote value changes, then doubles per stable pixel poll up to the
+    // ceiling. Only the pixel pins back off that far; mode, switch and
+    // threshold are still polled at least every CONTROL_POLL_CEILING_MS.
+    // getPollStats() reports both (see AdaptivePollScheduler::Stats).
+    void setPollPolicy(uint32_t burstIntervalMs, uint32_t ceilingIntervalMs, uint32_t burstCycles);
+    AdaptivePollScheduler::Stats getPollStats() const;
+
+    // Heap allocations made by the Blynk tasks during the last poll cycle
+    // (needs CONFIG_HEAP_USE_HOOKS, otherwise always 0)
+    uint32_t getLastCycleHeapAllocations() const;
+
+    // Per-pin latency histograms (connect/headers/body/total) and error
+    // counts of all Blynk requests since boot; also logged periodically
+    void dumpLatencyStats() const;
+    const BlynkLatencyStats& getLatencyStats() const;
     
 private:
+    static constexpr int MAX_VIRTUAL_PINS = 32;  // width of pendingWriteMask
+    static constexpr int SNAPSHOT_SLOTS = BlynkPinRegistry::maxPinNumber() + 1;
+    static constexpr size_t TELEMETRY_PIN_COUNT = BlynkPinRegistry::countInGroup(VirtualPinSpec::GROUP_TELEMETRY);
+    static constexpr int32_t DEFAULT_PUBLISH_DEADBAND_TENTHS = 5;
+    static constexpr uint32_t DEFAULT_HEARTBEAT_MS = 60000;
+    static constexpr uint32_t DEFAULT_BURST_INTERVAL_MS = 1000;
+    static constexpr uint32_t INITIAL_POLL_INTERVAL_MS = 3000;
+    static constexpr uint32_t DEFAULT_POLL_CEILING_MS = 30000;   // pixel pins
+    static constexpr uint32_t CONTROL_POLL_CEILING_MS = 3000;    // the fixed interval before adaptive polling
+    static constexpr uint32_t DEFAULT_BURST_CYCLES = 10;
+    static constexpr size_t PIN_VALUE_LENGTH = 16;
+    static constexpr size_t QUERY_BUFFER_SIZE = 320;
+    static constexpr size_t SYNC_RESPONSE_SIZE = 256;
+    static constexpr uint32_t DNS_TTL_MS = 300000;
+    static constexpr uint32_t SERVER_PROBE_INTERVAL_MS = 600000;
+    static constexpr size_t DRAIN_BATCH = 16;
+    static constexpr uint32_t DRAIN_INTERVAL_MS = 2000;
+    static constexpr size_t DRAIN_BODY_SIZE = 512;
+    static constexpr uint32_t LATENCY_DUMP_INTERVAL_MS = 300000;
+    // Monitor task notification bits
+    static constexpr uint32_t NOTIFY_REMOTE_CHANGE = 1UL << 0;
+    static constexpr uint32_t NOTIFY_NEW_SAMPLE = 1UL << 1;
+    static constexpr uint16_t CONTROLLER_FIELDS = ControlConfig::FIELD_MODE | ControlConfig::FIELD_SWITCH
+                                                | ControlConfig::FIELD_THRESHOLD;
+
     std::string authToken;
     std::string baseURL;
-    DHTSensor* dhtSensor;
+    ClimateSource* climateSource;
     HumidifierController* humidifierController;
     PixelManager* pixelManager;
-    bool autoMode;
-    bool manualSwitchOn;
+
+    // Settings being assembled from Blynk values (guarded by configMutex, as
+    // reads are dispatched from several tasks) and the copy readers see
+    ControlConfig workingConfig;
+    SemaphoreHandle_t configMutex;
+    SharedControlConfig sharedConfig;
+
+    BlynkHttpSession httpSession;  // keep-alive connection shared by all reads/writes
+    BlynkServerSelector servers;   // candidate servers with their DNS caches
+    int activeServer;
+    uint32_t lastServerProbeMs;
+
+    // Pending outgoing values, last write per pin wins
+    char pendingWrites[MAX_VIRTUAL_PINS][PIN_VALUE_LENGTH];
+    uint32_t pendingWriteMask;
+    char pushWrites[MAX_VIRTUAL_PINS][PIN_VALUE_LENGTH];  // values being pushed, monitor task only
+    SemaphoreHandle_t writeMutex;
+
+    // Last published value per telemetry pin, all values in tenths
+    struct TelemetryChannel {
+        const VirtualPinSpec* spec;
+        int32_t minTenths;  // spec range, converted once
+        int32_t maxTenths;
+        int32_t lastTenths;
+        uint32_t lastPublishMs;
+        uint32_t lastSampleMs;  // reading time of lastTenths
+        bool published;
+        TelemetryBuffer backlog;  // samples taken while the link was down
+    };
+    TelemetryChannel telemetryChannels[TELEMETRY_PIN_COUNT];
+    int32_t publishDeadbandTenths;
+    uint32_t publishHeartbeatMs;
+    PublishStats publishStats;
+    uint32_t lastSampleSequence;  // newest sensor sample already considered
+
+    // Async I/O; the flags keep at most one request of each kind in flight
+    BlynkLatencyStats latencyStats;
+    uint32_t lastLatencyDumpMs;
+    BlynkRequestEngine requestEngine;
+    std::atomic<bool> groupReadPending[VirtualPinSpec::GROUP_COUNT];
+    std::atomic<bool> writePending;
+
+    // Adaptive polling; remote changes are detected against the last value seen per pin
+    AdaptivePollScheduler pollScheduler;
+    uint32_t nextPixelPollMs;
+    TaskHandle_t monitorTaskHandle;
+    std::atomic<bool> remoteChanged;
+    float remoteValues[SNAPSHOT_SLOTS];
+    uint32_t remoteValueMask;
+
+    // Link state seen by the HTTP path, and the drain of the offline backlog.
+    // The backlog is owned by the monitor task; completions only post results.
+    enum DrainState { DRAIN_IDLE = 0, DRAIN_IN_FLIGHT, DRAIN_OK, DRAIN_FAILED };
+    std::atomic<bool> httpLinkUp;
+    uint32_t inFlightWriteMask;
+    std::atomic<uint32_t> failedWriteMask;
+    std::atomic<int> drainState;
+    size_t drainChannel;
+    uint32_t drainEndSeq;
+    uint32_t drainSampleCount;
+    uint32_t lastDrainMs;
+    uint32_t lastBacklogCheckMs;
+    uint32_t drainedSamples;
+    uint32_t drainActiveMs;
+    char drainBody[DRAIN_BODY_SIZE];  // POST body, kept alive until the drain completes
+
+    // Push transport, TCP or MQTT (null in HTTP mode), and the colour
+    // assembled from individually pushed V7-V9 writes
+    std::unique_ptr<BlynkPushTransport> pushTransport;
+    int pushedColour[3];
+
+    uint32_t lastCycleHeapAllocations;
 
     static void blynkMonitorTask(void* pvParameters);
+    void waitForNextPoll(uint32_t intervalMs);
+    static void onNewSample(void* context, const ClimateSample& sample);
     void updateSensorReadings();
-    std::string fetchFromBlynk(int virtualPin);
-    void sendToBlynk(int virtualPin, const std::string& value);
+    void maintainServerRoute(uint32_t nowMs);
+    void routeTo(int server);
+    void publishTelemetry(TelemetryChannel& channel, int32_t tenths, bool newSample, uint32_t sampleMs, uint32_t nowMs);
+    bool isLinkUp() const;
+    void rebufferFailedWrites();
+    void drainBacklog(uint32_t nowMs);
+    void finishDrain();
+    static bool getUnixTimeMs(int64_t& unixMs);
+    static void onDrainComplete(void* context, esp_err_t err, int statusCode, std::string_view response);
+    void logCycleStats();
+    static int32_t readTelemetry(const VirtualPinSpec& spec, const ClimateSample& sample);
+    static bool parsePinValue(const VirtualPinSpec& spec, std::string_view text, float& value);
+    void dispatchGroup(VirtualPinSpec::Group group, const std::string_view* values);
+    void noteRemoteValue(const VirtualPinSpec& spec, float value);
+    uint16_t dispatchPinValue(const VirtualPinSpec& spec, float value, int* colour);
+    void notifyController();
+    static void onBreakerStateChanged(void* context, CircuitBreaker::State state);
+    uint16_t applyColour(const int* colour);
+    void publishConfig(uint16_t changedFields);
+    bool isPushActive() const;
+    static void onPushedPinWrite(void* context, int pin, std::string_view value);
+    static void onPushConnected(void* context);
+    static bool parsePinSnapshot(std::string_view json, std::string_view* values, int maxPins);
+    size_t buildPinQuery(char* buffer, size_t size, VirtualPinSpec::Group group) const;
+    static bool readSnapshot(esp_err_t err, int statusCode, std::string_view response, std::string_view* values);
+    void completeGroupRead(VirtualPinSpec::Group group, esp_err_t err, int statusCode, std::string_view response);
+    static void onControlSnapshot(void* context, esp_err_t err, int statusCode, std::string_view response);
+    static void onPixelSnapshot(void* context, esp_err_t err, int statusCode, std::string_view response);
+    static void onBatchUpdateComplete(void* context, esp_err_t err, int statusCode, std::string_view response);
 };
@@ -0,0 +1,295 @@
+//BlynkMqttTransport.cpp
+#include "BlynkMqttTransport.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <charconv>
+#include <cstdio>
+
+static const char* TAG = "BlynkMqttTransport";
+
+static constexpr std::string_view DOWNLINK_DATASTREAM_PREFIX = "downlink/ds/";
+static constexpr std::string_view DOWNLINK_PREFIX = "downlink/";
+
+BlynkMqttTransport::BlynkMqttTransport(const std::string& brokerUri, const std::string& authToken, int qos)
+    : brokerUri(brokerUri), authToken(authToken), qos(qos > 0 ? 1 : 0), pinWriteHandler(nullptr),
+      connectedHandler(nullptr), handlerContext(nullptr), client(nullptr), connected(false),
+      timingMutex(xSemaphoreCreateMutex()), timedMsgId(TIMING_FREE), timedSentMs(0), earlyAckMsgId(-1), earlyAckMs(0),
+      connects(0), loginFailures(0), framesSent(0), framesReceived(0), bytesSent(0), roundTrips(0), lastRoundTripMs(0) {
+    if (timingMutex == nullptr) {
+        ESP_LOGE(TAG, "Failed to create timing mutex");
+    }
+}
+
+BlynkMqttTransport::~BlynkMqttTransport() {
+    if (client) {
+        esp_mqtt_client_stop(client);
+        esp_mqtt_client_destroy(client);
+        client = nullptr;
+    }
+    if (timingMutex) {
+        vSemaphoreDelete(timingMutex);
+        timingMutex = nullptr;
+    }
+}
+
+const char* BlynkMqttTransport::getName() const {
+    return "MQTT";
+}
+
+void BlynkMqttTransport::setHandlers(PinWriteHandler onPinWrite, ConnectedHandler onConnected, void* context) {
+    pinWriteHandler = onPinWrite;
+    connectedHandler = onConnected;
+    handlerContext = context;
+}
+
+esp_err_t BlynkMqttTransport::start() {
+    if (client) {
+        return ESP_OK;
+    }
+
+    if (timingMutex == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_mqtt_client_config_t config = {};
+    config.broker.address.uri = brokerUri.c_str();
+    // Blynk authenticates the device by its token as the password
+    config.credentials.username = "device";
+    config.credentials.authentication.password = authToken.c_str();
+    config.session.keepalive = KEEPALIVE_S;
+    config.network.reconnect_timeout_ms = RECONNECT_DELAY_MS;
+    config.network.timeout_ms = NETWORK_TIMEOUT_MS;
+    config.buffer.size = BUFFER_SIZE;
+
+    client = esp_mqtt_client_init(&config);
+    if (client == nullptr) {
+        ESP_LOGE(TAG, "Failed to init MQTT client");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_mqtt_client_register_event(client, MQTT_EVENT_ANY, eventHandler, this);
+    esp_err_t err = esp_mqtt_client_start(client);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start MQTT client: %s", esp_err_to_name(err));
+        esp_mqtt_client_destroy(client);
+        client = nullptr;
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Blynk MQTT transport started for %s (QoS %d)", brokerUri.c_str(), qos);
+    return ESP_OK;
+}
+
+bool BlynkMqttTransport::isConnected() const {
+    return connected;
+}
+
+// Runs on the esp-mqtt task
+void BlynkMqttTransport::eventHandler(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData) {
+    BlynkMqttTransport* transport = static_cast<BlynkMqttTransport*>(handlerArgs);
+    const esp_mqtt_event_t* event = static_cast<const esp_mqtt_event_t*>(eventData);
+
+    switch (static_cast<esp_mqtt_event_id_t>(eventId)) {
+        case MQTT_EVENT_CONNECTED:
+            transport->onConnected();
+            break;
+
+        case MQTT_EVENT_DISCONNECTED:
+            if (transport->connected.exchange(false)) {
+                ESP_LOGW(TAG, "Disconnected from broker, reconnecting in %d ms", RECONNECT_DELAY_MS);
+            }
+            // An ack for the timed publish will not come any more
+            xSemaphoreTake(transport->timingMutex, portMAX_DELAY);
+            transport->timedMsgId = TIMING_FREE;
+            xSemaphoreGive(transport->timingMutex);
+            break;
+
+        case MQTT_EVENT_DATA:
+            transport->framesReceived++;
+            transport->onData(*event);
+            break;
+
+        case MQTT_EVENT_PUBLISHED:
+            transport->onPublished(event->msg_id);
+            break;
+
+        case MQTT_EVENT_ERROR:
+            if (event->error_handle && event->error_handle->error_type == MQTT_ERROR_TYPE_CONNECTION_REFUSED) {
+                transport->loginFailures++;
+                ESP_LOGE(TAG, "Broker refused the connection (code %d), check the auth token",
+                         event->error_handle->connect_return_code);
+            } else {
+                ESP_LOGW(TAG, "MQTT transport error");
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void BlynkMqttTransport::onConnected() {
+    connects++;
+
+    // Everything the server sends to the device; datastream writes are
+    // handled, other downlink topics (redirect, reboot, ...) are only logged
+    if (esp_mqtt_client_subscribe_single(client, "downlink/#", qos) < 0) {
+        ESP_LOGE(TAG, "Failed to subscribe to downlink topics");
+    }
+
+    connected = true;
+    ESP_LOGI(TAG, "Connected to %s", brokerUri.c_str());
+
+    if (connectedHandler) {
+        connectedHandler(handlerContext);
+    }
+}
+
+void BlynkMqttTransport::onData(const esp_mqtt_event_t& event) {
+    std::string_view topic(event.topic, event.topic_len);
+    std::string_view payload(event.data, event.data_len);
+
+    // Pin values are far smaller than the buffer; a split message is not a pin write
+    if (event.current_data_offset != 0 || event.data_len != event.total_data_len) {
+        ESP_LOGW(TAG, "Ignoring fragmented message (%d bytes)", event.total_data_len);
+        return;
+    }
+
+    if (topic.substr(0, DOWNLINK_DATASTREAM_PREFIX.size()) != DOWNLINK_DATASTREAM_PREFIX) {
+        if (topic.substr(0, DOWNLINK_PREFIX.size()) == DOWNLINK_PREFIX) {
+            ESP_LOGW(TAG, "Unhandled downlink %.*s: %.*s", (int)topic.size(), topic.data(),
+                     (int)payload.size(), payload.data());
+        }
+        return;
+    }
+
+    int pin = -1;
+    std::string_view name = topic.substr(DOWNLINK_DATASTREAM_PREFIX.size());
+    if (!parseDatastreamPin(name, pin)) {
+        ESP_LOGW(TAG, "Ignoring write to datastream '%.*s'", (int)name.size(), name.data());
+        return;
+    }
+
+    if (pinWriteHandler) {
+        pinWriteHandler(handlerContext, pin, payload);
+    }
+}
+
+void BlynkMqttTransport::onPublished(int msgId) {
+    if (msgId <= 0) {
+        return;
+    }
+
+    uint32_t ackMs = nowMs();
+    xSemaphoreTake(timingMutex, portMAX_DELAY);
+    if (timedMsgId == msgId) {
+        recordRoundTrip(ackMs - timedSentMs);
+        timedMsgId = TIMING_FREE;
+    } else if (timedMsgId == TIMING_PENDING) {
+        // Possibly ours, acked before publish() learned its id
+        earlyAckMsgId = msgId;
+        earlyAckMs = ackMs;
+    }
+    xSemaphoreGive(timingMutex);
+}
+
+esp_err_t BlynkMqttTransport::virtualWrite(int pin, std::string_view value) {
+    char topic[TOPIC_SIZE];
+    snprintf(topic, sizeof(topic), "ds/V%d", pin);
+    return publish(topic, value);
+}
+
+esp_err_t BlynkMqttTransport::syncVirtual(const int* pins, size_t count) {
+    // get/ds takes a comma separated list of datastream names
+    char payload[SYNC_PAYLOAD_SIZE];
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int written = snprintf(payload + length, sizeof(payload) - length, "%sV%d", i == 0 ? "" : ",", pins[i]);
+        if (written < 0 || static_cast<size_t>(written) >= sizeof(payload) - length) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        length += written;
+    }
+    return publish("get/ds", std::string_view(payload, length));
+}
+
+esp_err_t BlynkMqttTransport::publish(const char* topic, std::string_view payload) {
+    if (!connected) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // QoS 0 publishes have no ack to time
+    bool timed = qos > 0 && reserveTiming(nowMs());
+    int msgId = esp_mqtt_client_publish(client, topic, payload.data(), static_cast<int>(payload.size()), qos, 0);
+    if (timed) {
+        completeTiming(msgId);
+    }
+    if (msgId < 0) {
+        ESP_LOGW(TAG, "Publish to %s failed", topic);
+        return ESP_FAIL;
+    }
+
+    framesSent++;
+    bytesSent += payload.size();
+    return ESP_OK;
+}
+
+// Takes the timing slot unless another publish is still waiting for its ack
+bool BlynkMqttTransport::reserveTiming(uint32_t sentMs) {
+    xSemaphoreTake(timingMutex, portMAX_DELAY);
+    bool reserved = timedMsgId == TIMING_FREE
+                 || (timedMsgId != TIMING_PENDING && sentMs - timedSentMs > ROUND_TRIP_TIMEOUT_MS);
+    if (reserved) {
+        timedMsgId = TIMING_PENDING;
+        timedSentMs = sentMs;
+        earlyAckMsgId = -1;
+    }
+    xSemaphoreGive(timingMutex);
+    return reserved;
+}
+
+void BlynkMqttTransport::completeTiming(int msgId) {
+    xSemaphoreTake(timingMutex, portMAX_DELAY);
+    // Freed in the meantime if the link dropped
+    if (timedMsgId == TIMING_PENDING) {
+        if (msgId <= 0) {
+            timedMsgId = TIMING_FREE;
+        } else if (earlyAckMsgId == msgId) {
+            recordRoundTrip(earlyAckMs - timedSentMs);
+            timedMsgId = TIMING_FREE;
+        } else {
+            timedMsgId = msgId;
+        }
+    }
+    xSemaphoreGive(timingMutex);
+}
+
+void BlynkMqttTransport::recordRoundTrip(uint32_t roundTripMs) {
+    lastRoundTripMs = roundTripMs;
+    roundTrips++;
+}
+
+bool BlynkMqttTransport::parseDatastreamPin(std::string_view name, int& pin) {
+    if (name.size() < 2 || (name[0] != 'V' && name[0] != 'v')) {
+        return false;
+    }
+    const char* end = name.data() + name.size();
+    auto result = std::from_chars(name.data() + 1, end, pin);
+    return result.ec == std::errc() && result.ptr == end && pin >= 0;
+}
+
+BlynkMqttTransport::Stats BlynkMqttTransport::getStats() const {
+    Stats stats = {};
+    stats.connects = connects;
+    stats.loginFailures = loginFailures;
+    stats.framesSent = framesSent;
+    stats.framesReceived = framesReceived;
+    stats.bytesSent = bytesSent;
+    stats.roundTrips = roundTrips;
+    stats.lastRoundTripMs = lastRoundTripMs;
+    return stats;
+}
+
+uint32_t BlynkMqttTransport::nowMs() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
@@ -0,0 +1,84 @@
+//BlynkMqttTransport.hpp
+#pragma once
+
+#include "BlynkPushTransport.hpp"
+#include "mqtt_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <atomic>
+#include <string>
+#include <string_view>
+
+// Blynk's MQTT API as a push transport, on top of esp-mqtt (which owns the
+// connection task, keepalive and reconnects). App writes arrive on
+// downlink/ds/<datastream>; telemetry is published to ds/<datastream>.
+// Datastreams are addressed by their pin name ("V0", "V3", ...), so they
+// must be named that way in the template. The broker URI is configurable,
+// which lets a local mosquitto instance stand in for Blynk.
+class BlynkMqttTransport : public BlynkPushTransport {
+public:
+    // qos 0: fire and forget, 1: publishes are acknowledged (and timed)
+    BlynkMqttTransport(const std::string& brokerUri, const std::string& authToken, int qos);
+    ~BlynkMqttTransport() override;
+
+    const char* getName() const override;
+    void setHandlers(PinWriteHandler onPinWrite, ConnectedHandler onConnected, void* context) override;
+    esp_err_t start() override;
+    bool isConnected() const override;
+
+    esp_err_t virtualWrite(int pin, std::string_view value) override;
+    esp_err_t syncVirtual(const int* pins, size_t count) override;
+
+    Stats getStats() const override;
+
+private:
+    static constexpr int KEEPALIVE_S = 45;
+    static constexpr int RECONNECT_DELAY_MS = 5000;
+    static constexpr int NETWORK_TIMEOUT_MS = 5000;
+    static constexpr int BUFFER_SIZE = 512;
+    static constexpr uint32_t ROUND_TRIP_TIMEOUT_MS = 10000;
+    static constexpr size_t TOPIC_SIZE = 32;
+    static constexpr size_t SYNC_PAYLOAD_SIZE = 96;
+    static constexpr int TIMING_FREE = -1;
+    static constexpr int TIMING_PENDING = -2;  // publishing, msg id not known yet
+
+    static void eventHandler(void* handlerArgs, esp_event_base_t base, int32_t eventId, void* eventData);
+    void onConnected();
+    void onData(const esp_mqtt_event_t& event);
+    void onPublished(int msgId);
+    esp_err_t publish(const char* topic, std::string_view payload);
+    bool reserveTiming(uint32_t sentMs);
+    void completeTiming(int msgId);
+    void recordRoundTrip(uint32_t roundTripMs);
+    static bool parseDatastreamPin(std::string_view name, int& pin);
+    static uint32_t nowMs();
+
+    std::string brokerUri;
+    std::string authToken;
+    int qos;
+    PinWriteHandler pinWriteHandler;
+    ConnectedHandler connectedHandler;
+    void* handlerContext;
+
+    esp_mqtt_client_handle_t client;
+    std::atomic<bool> connected;
+
+    // One publish at a time is timed until its ack arrives. The slot is
+    // taken before publishing: the MQTT task can handle the ack before
+    // esp_mqtt_client_publish() has returned the id, and such an early ack
+    // is parked until the id is known.
+    SemaphoreHandle_t timingMutex;
+    int timedMsgId;        // TIMING_FREE, TIMING_PENDING or the publish being timed
+    uint32_t timedSentMs;
+    int earlyAckMsgId;
+    uint32_t earlyAckMs;
+
+    // Counters behind getStats(), written from the MQTT task and publishers
+    std::atomic<uint32_t> connects;
+    std::atomic<uint32_t> loginFailures;
+    std::atomic<uint32_t> framesSent;
+    std::atomic<uint32_t> framesReceived;
+    std::atomic<uint32_t> bytesSent;
+    std::atomic<uint32_t> roundTrips;
+    std::atomic<uint32_t> lastRoundTripMs;
+};
@@ -0,0 +1,111 @@
+//BlynkPinRegistry.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Static description of one Blynk virtual pin
+struct VirtualPinSpec {
+    enum Direction : uint8_t {
+        DOWNLINK = 0,   // app -> device, polled
+        UPLINK          // device -> app, published
+    };
+
+    enum ValueType : uint8_t {
+        TYPE_BOOL = 0,
+        TYPE_INT,
+        TYPE_FLOAT
+    };
+
+    // Pins in one group are read or written together in a single request
+    enum Group : uint8_t {
+        GROUP_CONTROL = 0,
+        GROUP_PIXEL,
+        GROUP_TELEMETRY,
+        GROUP_COUNT
+    };
+
+    enum Handler : uint8_t {
+        HANDLER_CONTROL_MODE = 0,
+        HANDLER_MANUAL_SWITCH,
+        HANDLER_HUMIDITY_THRESHOLD,
+        HANDLER_PIXEL_MODE,
+        HANDLER_PIXEL_BRIGHTNESS,
+        HANDLER_PIXEL_RED,
+        HANDLER_PIXEL_GREEN,
+        HANDLER_PIXEL_BLUE,
+        HANDLER_TEMPERATURE,
+        HANDLER_HUMIDITY
+    };
+
+    uint8_t pin;
+    Direction direction;
+    ValueType type;
+    Group group;
+    float minValue;
+    float maxValue;
+    Handler handler;
+};
+
+// Every virtual pin the firmware uses. Adding a pin is one entry here plus a
+// case in BlynkManager's handler switch. Within a group, entries are
+// dispatched in table order (V3 mode is applied before the V2 switch).
+class BlynkPinRegistry {
+public:
+    static constexpr VirtualPinSpec PINS[] = {
+        //pin  direction                  type                        group                          min     max     handler
+        { 0, VirtualPinSpec::UPLINK,   VirtualPinSpec::TYPE_FLOAT, VirtualPinSpec::GROUP_TELEMETRY, -40.0f,  80.0f, VirtualPinSpec::HANDLER_TEMPERATURE },
+        { 1, VirtualPinSpec::UPLINK,   VirtualPinSpec::TYPE_FLOAT, VirtualPinSpec::GROUP_TELEMETRY,   0.0f, 100.0f, VirtualPinSpec::HANDLER_HUMIDITY },
+        { 3, VirtualPinSpec::DOWNLINK, VirtualPinSpec::TYPE_BOOL,  VirtualPinSpec::GROUP_CONTROL,     0.0f,   1.0f, VirtualPinSpec::HANDLER_CONTROL_MODE },
+        { 2, VirtualPinSpec::DOWNLINK, VirtualPinSpec::TYPE_BOOL,  VirtualPinSpec::GROUP_CONTROL,     0.0f,   1.0f, VirtualPinSpec::HANDLER_MANUAL_SWITCH },
+        { 4, VirtualPinSpec::DOWNLINK, VirtualPinSpec::TYPE_FLOAT, VirtualPinSpec::GROUP_CONTROL,     0.0f, 100.0f, VirtualPinSpec::HANDLER_HUMIDITY_THRESHOLD },
+        { 5, VirtualPinSpec::DOWNLINK, VirtualPinSpec::TYPE_INT,   VirtualPinSpec::GROUP_PIXEL,       0.0f,   4.0f, VirtualPinSpec::HANDLER_PIXEL_MODE },
+        { 6, VirtualPinSpec::DOWNLINK, VirtualPinSpec::TYPE_INT,   VirtualPinSpec::GROUP_PIXEL,       0.0f, 100.0f, VirtualPinSpec::HANDLER_PIXEL_BRIGHTNESS },
+        { 7, VirtualPinSpec::DOWNLINK, VirtualPinSpec::TYPE_INT,   VirtualPinSpec::GROUP_PIXEL,       0.0f, 255.0f, VirtualPinSpec::HANDLER_PIXEL_RED },
+        { 8, VirtualPinSpec::DOWNLINK, VirtualPinSpec::TYPE_INT,   VirtualPinSpec::GROUP_PIXEL,       0.0f, 255.0f, VirtualPinSpec::HANDLER_PIXEL_GREEN },
+        { 9, VirtualPinSpec::DOWNLINK, VirtualPinSpec::TYPE_INT,   VirtualPinSpec::GROUP_PIXEL,       0.0f, 255.0f, VirtualPinSpec::HANDLER_PIXEL_BLUE },
+    };
+
+    static constexpr size_t PIN_COUNT = sizeof(PINS) / sizeof(PINS[0]);
+
+    static constexpr int maxPinNumber() {
+        int highest = 0;
+        for (size_t i = 0; i < PIN_COUNT; ++i) {
+            if (PINS[i].pin > highest) {
+                highest = PINS[i].pin;
+            }
+        }
+        return highest;
+    }
+
+    static constexpr size_t countInGroup(VirtualPinSpec::Group group) {
+        size_t count = 0;
+        for (size_t i = 0; i < PIN_COUNT; ++i) {
+            if (PINS[i].group == group) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    static constexpr uint32_t groupMask(VirtualPinSpec::Group group) {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < PIN_COUNT; ++i) {
+            if (PINS[i].group == group) {
+                mask |= 1UL << PINS[i].pin;
+            }
+        }
+        return mask;
+    }
+
+    static constexpr const VirtualPinSpec* find(int pin) {
+        for (size_t i = 0; i < PIN_COUNT; ++i) {
+            if (PINS[i].pin == pin) {
+                return &PINS[i];
+            }
+        }
+        return nullptr;
+    }
+};
+
+static_assert(BlynkPinRegistry::maxPinNumber() < 32, "Virtual pins must fit the 32-bit pin masks");
@@ -0,0 +1,112 @@
+//BlynkProtocol.cpp
+#include "BlynkProtocol.hpp"
+#include <charconv>
+#include <cstring>
+
+static void writeHeader(uint8_t* buffer, uint8_t command, uint16_t msgId, uint16_t length) {
+    buffer[0] = command;
+    buffer[1] = static_cast<uint8_t>(msgId >> 8);
+    buffer[2] = static_cast<uint8_t>(msgId & 0xFF);
+    buffer[3] = static_cast<uint8_t>(length >> 8);
+    buffer[4] = static_cast<uint8_t>(length & 0xFF);
+}
+
+// Appends text plus its '\0' separator, returns false once it no longer fits
+static bool appendField(char* body, size_t size, size_t& length, std::string_view field) {
+    if (length + field.size() + 1 > size) {
+        return false;
+    }
+    memcpy(body + length, field.data(), field.size());
+    length += field.size();
+    body[length++] = '\0';
+    return true;
+}
+
+static bool appendPinField(char* body, size_t size, size_t& length, int pin) {
+    char digits[12];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), pin);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    return appendField(body, size, length, std::string_view(digits, result.ptr - digits));
+}
+
+size_t BlynkProtocol::encodeFrame(uint8_t* buffer, size_t size, uint8_t command, uint16_t msgId, std::string_view body) {
+    if (body.size() > UINT16_MAX || HEADER_SIZE + body.size() > size) {
+        return 0;
+    }
+
+    writeHeader(buffer, command, msgId, static_cast<uint16_t>(body.size()));
+    memcpy(buffer + HEADER_SIZE, body.data(), body.size());
+    return HEADER_SIZE + body.size();
+}
+
+size_t BlynkProtocol::encodeResponse(uint8_t* buffer, size_t size, uint16_t msgId, uint16_t status) {
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+
+    writeHeader(buffer, CMD_RESPONSE, msgId, status);
+    return HEADER_SIZE;
+}
+
+bool BlynkProtocol::decodeHeader(const uint8_t* data, size_t size, Header& header) {
+    if (size < HEADER_SIZE) {
+        return false;
+    }
+
+    header.command = data[0];
+    header.msgId = static_cast<uint16_t>((data[1] << 8) | data[2]);
+    header.length = static_cast<uint16_t>((data[3] << 8) | data[4]);
+    return true;
+}
+
+size_t BlynkProtocol::buildVirtualWrite(char* body, size_t size, int pin, std::string_view value) {
+    size_t length = 0;
+    if (!appendField(body, size, length, "vw") || !appendPinField(body, size, length, pin)
+        || length + value.size() > size) {
+        return 0;
+    }
+
+    // Last field carries no trailing separator
+    memcpy(body + length, value.data(), value.size());
+    return length + value.size();
+}
+
+size_t BlynkProtocol::buildVirtualSync(char* body, size_t size, const int* pins, size_t count) {
+    size_t length = 0;
+    if (count == 0 || !appendField(body, size, length, "vr")) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!appendPinField(body, size, length, pins[i])) {
+            return 0;
+        }
+    }
+    return length - 1;  // drop the trailing separator
+}
+
+bool BlynkProtocol::parseVirtualWrite(std::string_view body, int& pin, std::string_view& value) {
+    std::string_view fields = body;
+    if (nextField(fields) != "vw") {
+        return false;
+    }
+
+    std::string_view pinField = nextField(fields);
+    std::from_chars_result result = std::from_chars(pinField.data(), pinField.data() + pinField.size(), pin);
+    if (pinField.empty() || result.ec != std::errc() || result.ptr != pinField.data() + pinField.size()) {
+        return false;
+    }
+
+    // Multi-value writes (arrays) keep only their first element
+    value = nextField(fields);
+    return true;
+}
+
+std::string_view BlynkProtocol::nextField(std::string_view& fields) {
+    size_t separator = fields.find('\0');
+    std::string_view field = fields.substr(0, separator);
+    fields = separator == std::string_view::npos ? std::string_view() : fields.substr(separator + 1);
+    return field;
+}
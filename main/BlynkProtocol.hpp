@@ -0,0 +1,52 @@
+//BlynkProtocol.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Framing for Blynk's binary hardware protocol. Every message is a 5 byte
+// header (command, message id, body length; all big endian) followed by a
+// body whose fields are separated by '\0'. RESPONSE messages have no body and
+// carry a status code in the length field. No IDF dependencies, so the codec
+// builds on a Linux host as is.
+class BlynkProtocol {
+public:
+    enum Command : uint8_t {
+        CMD_RESPONSE = 0,
+        CMD_PING = 6,
+        CMD_HARDWARE_SYNC = 16,
+        CMD_INTERNAL = 17,
+        CMD_HARDWARE = 20,
+        CMD_HW_LOGIN = 29,
+        CMD_REDIRECT = 41
+    };
+
+    enum Status : uint16_t {
+        STATUS_INVALID_TOKEN = 9,
+        STATUS_SUCCESS = 200
+    };
+
+    struct Header {
+        uint8_t command;
+        uint16_t msgId;
+        uint16_t length;  // status code for CMD_RESPONSE
+    };
+
+    static constexpr size_t HEADER_SIZE = 5;
+
+    // Writes header + body into buffer, returns the frame size or 0 if it does not fit
+    static size_t encodeFrame(uint8_t* buffer, size_t size, uint8_t command, uint16_t msgId, std::string_view body);
+    static size_t encodeResponse(uint8_t* buffer, size_t size, uint16_t msgId, uint16_t status);
+    static bool decodeHeader(const uint8_t* data, size_t size, Header& header);
+
+    // Bodies: "vw\0<pin>\0<value>" and "vr\0<pin>\0<pin>..."; return the body length or 0
+    static size_t buildVirtualWrite(char* body, size_t size, int pin, std::string_view value);
+    static size_t buildVirtualSync(char* body, size_t size, const int* pins, size_t count);
+
+    // Splits a HARDWARE body sent by the server; only virtual writes are accepted
+    static bool parseVirtualWrite(std::string_view body, int& pin, std::string_view& value);
+
+    // Returns the next '\0' separated field and advances `fields` past it
+    static std::string_view nextField(std::string_view& fields);
+};
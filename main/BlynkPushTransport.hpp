@@ -0,0 +1,42 @@
+//BlynkPushTransport.hpp
+#pragma once
+
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Persistent link to Blynk over which the server pushes app writes as they
+// happen, instead of the HTTP API being polled. Implemented by the hardware
+// protocol over TCP and by MQTT; BlynkManager only talks to this interface.
+class BlynkPushTransport {
+public:
+    // Both handlers run on the transport's task; `value` is only valid during the call
+    typedef void (*PinWriteHandler)(void* context, int pin, std::string_view value);
+    typedef void (*ConnectedHandler)(void* context);
+
+    struct Stats {
+        uint32_t connects;
+        uint32_t loginFailures;    // server rejected the auth token
+        uint32_t redirects;        // server moved the device to another node
+        uint32_t pingTimeouts;     // link found dead by the keepalive
+        uint32_t framesSent;       // frames or messages
+        uint32_t framesReceived;
+        uint32_t bytesSent;
+        uint32_t roundTrips;       // timed pings answered (TCP) or publishes acked (MQTT QoS 1)
+        uint32_t lastRoundTripMs;  // of the latest of those
+    };
+
+    virtual ~BlynkPushTransport() = default;
+
+    virtual const char* getName() const = 0;
+    virtual void setHandlers(PinWriteHandler onPinWrite, ConnectedHandler onConnected, void* context) = 0;
+    virtual esp_err_t start() = 0;
+    virtual bool isConnected() const = 0;
+
+    virtual esp_err_t virtualWrite(int pin, std::string_view value) = 0;
+    // Asks the server to push the current value of each pin
+    virtual esp_err_t syncVirtual(const int* pins, size_t count) = 0;
+
+    virtual Stats getStats() const = 0;
+};
@@ -0,0 +1,135 @@
+//BlynkRequestEngine.cpp
+#include "BlynkRequestEngine.hpp"
+#include "HeapMonitor.hpp"
+#include "esp_log.h"
+#include <cstring>
+
+static const char* TAG = "BlynkRequestEngine";
+
+BlynkRequestEngine::BlynkRequestEngine(BlynkHttpSession* session, BlynkLatencyStats* latencyStats)
+    : session(session), latencyStats(latencyStats), queues{}, ioTaskHandle(nullptr), responseBuffer{} {}
+
+BlynkRequestEngine::~BlynkRequestEngine() {
+    if (ioTaskHandle != nullptr) {
+        vTaskDelete(ioTaskHandle);
+        ioTaskHandle = nullptr;
+    }
+    for (int i = 0; i < PRIORITY_COUNT; ++i) {
+        if (queues[i] != nullptr) {
+            vQueueDelete(queues[i]);
+            queues[i] = nullptr;
+        }
+    }
+}
+
+esp_err_t BlynkRequestEngine::start() {
+    for (int i = 0; i < PRIORITY_COUNT; ++i) {
+        queues[i] = xQueueCreate(QUEUE_DEPTH, sizeof(Request));
+        if (queues[i] == nullptr) {
+            ESP_LOGE(TAG, "Failed to create request queue %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    BaseType_t result = xTaskCreate(
+        ioTaskWrapper,
+        "blynkIoTask",
+        TASK_STACK_SIZE,
+        this,
+        TASK_PRIORITY,
+        &ioTaskHandle
+    );
+
+    if (result != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create blynkIoTask");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Successfully created blynkIoTask");
+    return ESP_OK;
+}
+
+bool BlynkRequestEngine::submit(Priority priority, std::string_view pathAndQuery, uint32_t pinMask, Completion completion,
+                                void* context, std::string_view body) {
+    if (priority >= PRIORITY_COUNT || queues[priority] == nullptr || ioTaskHandle == nullptr) {
+        ESP_LOGW(TAG, "Request engine not running");
+        return false;
+    }
+
+    if (pathAndQuery.size() >= MAX_QUERY_LENGTH) {
+        ESP_LOGE(TAG, "Query too long (%u bytes), dropping", (unsigned)pathAndQuery.size());
+        return false;
+    }
+
+    Request request = {};
+    memcpy(request.query, pathAndQuery.data(), pathAndQuery.size());
+    request.query[pathAndQuery.size()] = '\0';
+    request.body = body.data();
+    request.bodyLength = body.size();
+    request.pinMask = pinMask;
+    request.completion = completion;
+    request.context = context;
+
+    if (xQueueSend(queues[priority], &request, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Request queue %d full, dropping request", priority);
+        return false;
+    }
+
+    xTaskNotifyGive(ioTaskHandle);
+    return true;
+}
+
+uint32_t BlynkRequestEngine::getPendingCount() const {
+    uint32_t pending = 0;
+    for (int i = 0; i < PRIORITY_COUNT; ++i) {
+        if (queues[i] != nullptr) {
+            pending += uxQueueMessagesWaiting(queues[i]);
+        }
+    }
+    return pending;
+}
+
+bool BlynkRequestEngine::takeNextRequest(Request& request) {
+    for (int i = 0; i < PRIORITY_COUNT; ++i) {
+        if (xQueueReceive(queues[i], &request, 0) == pdTRUE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BlynkRequestEngine::ioTaskWrapper(void* parameter) {
+    BlynkRequestEngine* engine = static_cast<BlynkRequestEngine*>(parameter);
+    engine->ioTask();
+}
+
+void BlynkRequestEngine::ioTask() {
+    Request request;
+
+    HeapMonitor::watchCurrentTask();
+
+    while (true) {
+        // Re-check from the highest priority after every request so a control
+        // read never waits behind more than one lower priority request
+        if (!takeNextRequest(request)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        int statusCode = 0;
+        size_t responseLength = 0;
+        BlynkHttpSession::Timing timing = {};
+        esp_err_t err = request.bodyLength > 0
+            ? session->post(request.query, std::string_view(request.body, request.bodyLength), responseBuffer,
+                            sizeof(responseBuffer), &responseLength, &statusCode, &timing)
+            : session->get(request.query, responseBuffer, sizeof(responseBuffer), &responseLength, &statusCode, &timing);
+
+        if (latencyStats) {
+            latencyStats->recordRequest(request.pinMask, err, statusCode, timing);
+        }
+
+        if (request.completion) {
+            request.completion(request.context, err, statusCode, std::string_view(responseBuffer, responseLength));
+        }
+    }
+}
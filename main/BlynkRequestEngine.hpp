@@ -0,0 +1,66 @@
+//BlynkRequestEngine.hpp
+#pragma once
+
+#include "BlynkHttpSession.hpp"
+#include "BlynkLatencyStats.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <string_view>
+
+// Asynchronous front end for BlynkHttpSession. Callers enqueue requests with a
+// priority and a dedicated I/O task executes them, always draining higher
+// priority queues first. Completions run on the I/O task. When given a
+// BlynkLatencyStats, every request is recorded under the pins it carries.
+class BlynkRequestEngine {
+public:
+    enum Priority {
+        PRIORITY_HIGH = 0,   // control pins (mode, switch, threshold)
+        PRIORITY_NORMAL,     // telemetry uploads
+        PRIORITY_LOW,        // cosmetic pins (pixel mode, brightness, colour)
+        PRIORITY_COUNT
+    };
+
+    // The response view points into the engine's receive buffer and is only
+    // valid for the duration of the callback
+    typedef void (*Completion)(void* context, esp_err_t err, int statusCode, std::string_view response);
+
+    explicit BlynkRequestEngine(BlynkHttpSession* session, BlynkLatencyStats* latencyStats = nullptr);
+    ~BlynkRequestEngine();
+
+    esp_err_t start();
+
+    // Queues a GET of session base URL + pathAndQuery, or a POST when a body
+    // is given (the caller keeps the body alive until the completion runs).
+    // pinMask names the virtual pins the request reads or writes.
+    // Returns false if the queue for that priority is full or the query does not fit.
+    bool submit(Priority priority, std::string_view pathAndQuery, uint32_t pinMask, Completion completion, void* context,
+                std::string_view body = std::string_view());
+    uint32_t getPendingCount() const;
+
+private:
+    static constexpr size_t MAX_QUERY_LENGTH = 320;
+    static constexpr size_t RESPONSE_BUFFER_SIZE = 512;
+    static constexpr uint32_t QUEUE_DEPTH = 4;
+    static constexpr uint32_t TASK_STACK_SIZE = 8192;  // room for an mbedTLS handshake
+    static constexpr UBaseType_t TASK_PRIORITY = 2;
+
+    struct Request {
+        char query[MAX_QUERY_LENGTH];
+        const char* body;
+        size_t bodyLength;
+        uint32_t pinMask;
+        Completion completion;
+        void* context;
+    };
+
+    static void ioTaskWrapper(void* parameter);
+    void ioTask();
+    bool takeNextRequest(Request& request);
+
+    BlynkHttpSession* session;
+    BlynkLatencyStats* latencyStats;
+    QueueHandle_t queues[PRIORITY_COUNT];
+    TaskHandle_t ioTaskHandle;
+    char responseBuffer[RESPONSE_BUFFER_SIZE];  // owned by the I/O task
+};
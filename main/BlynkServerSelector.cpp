@@ -0,0 +1,164 @@
+//BlynkServerSelector.cpp
+#include "BlynkServerSelector.hpp"
+#include "BlynkHttpSession.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+static const char* TAG = "BlynkServerSelector";
+
+BlynkServerSelector::BlynkServerSelector(uint32_t dnsTtlMs)
+    : dnsTtlMs(dnsTtlMs), servers{}, serverCount(0) {}
+
+bool BlynkServerSelector::addServer(const std::string& baseURL) {
+    if (serverCount >= MAX_SERVERS) {
+        ESP_LOGW(TAG, "Server list full, ignoring %s", baseURL.c_str());
+        return false;
+    }
+
+    BlynkHttpSession::URLParts parts;
+    BlynkHttpSession::parseBaseURL(baseURL, parts);
+
+    Candidate& server = servers[serverCount++];
+    server.baseURL = baseURL;
+    server.port = parts.port;
+    server.dns = std::make_unique<DnsCache>(parts.host, dnsTtlMs);
+    server.rttMs = 0;
+    server.measured = false;
+    server.healthy = true;
+    server.probes = 0;
+    server.probeFailures = 0;
+    return true;
+}
+
+size_t BlynkServerSelector::getServerCount() const {
+    return serverCount;
+}
+
+void BlynkServerSelector::probeAll() {
+    for (size_t i = 0; i < serverCount; ++i) {
+        Candidate& server = servers[i];
+        uint32_t sampleMs = 0;
+
+        server.probes++;
+        if (!measureConnect(server, sampleMs)) {
+            server.probeFailures++;
+            server.healthy = false;
+            ESP_LOGW(TAG, "%s unreachable", server.baseURL.c_str());
+            continue;
+        }
+
+        // Smoothed like TCP's SRTT, weight 1/4 on the new sample
+        server.rttMs = server.measured ? (3 * server.rttMs + sampleMs) / 4 : sampleMs;
+        server.measured = true;
+        server.healthy = true;
+        ESP_LOGI(TAG, "%s: %lu ms (smoothed %lu ms)", server.baseURL.c_str(), (unsigned long)sampleMs,
+                 (unsigned long)server.rttMs);
+    }
+}
+
+int BlynkServerSelector::selectBest(int current) const {
+    int best = -1;
+    for (size_t i = 0; i < serverCount; ++i) {
+        const Candidate& server = servers[i];
+        if (!server.healthy || !server.measured) {
+            continue;
+        }
+        if (best < 0 || server.rttMs < servers[best].rttMs) {
+            best = static_cast<int>(i);
+        }
+    }
+
+    if (best < 0) {
+        // Nothing measured yet: first healthy server in list order
+        for (size_t i = 0; i < serverCount && best < 0; ++i) {
+            if (servers[i].healthy) {
+                best = static_cast<int>(i);
+            }
+        }
+        return best < 0 ? current : best;
+    }
+
+    // Stay put unless the rival is clearly faster
+    if (current >= 0 && static_cast<size_t>(current) < serverCount && current != best) {
+        const Candidate& active = servers[current];
+        if (active.healthy && active.measured
+            && servers[best].rttMs * (100 + SWITCH_MARGIN_PERCENT) >= active.rttMs * 100) {
+            return current;
+        }
+    }
+    return best;
+}
+
+void BlynkServerSelector::markUnhealthy(int index) {
+    if (index >= 0 && static_cast<size_t>(index) < serverCount) {
+        servers[index].healthy = false;
+    }
+}
+
+const std::string& BlynkServerSelector::getBaseURL(int index) const {
+    return servers[index].baseURL;
+}
+
+DnsCache* BlynkServerSelector::getDnsCache(int index) {
+    return servers[index].dns.get();
+}
+
+BlynkServerSelector::ServerStatus BlynkServerSelector::getStatus(int index) const {
+    const Candidate& server = servers[index];
+    return ServerStatus{ server.baseURL.c_str(), server.rttMs, server.healthy, server.probes, server.probeFailures };
+}
+
+bool BlynkServerSelector::measureConnect(Candidate& server, uint32_t& rttMs) {
+    server.dns->refresh();
+
+    char address[16];
+    if (!server.dns->getAddress(address, sizeof(address))) {
+        return false;
+    }
+
+    struct sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(server.port);
+    inet_pton(AF_INET, address, &target.sin_addr);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    // Non-blocking connect so a dead server costs at most CONNECT_TIMEOUT_MS
+    int64_t startUs = esp_timer_get_time();
+    bool connected = connect(fd, reinterpret_cast<struct sockaddr*>(&target), sizeof(target)) == 0;
+    if (!connected && errno == EINPROGRESS) {
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(fd, &writable);
+        struct timeval timeout = {};
+        timeout.tv_sec = CONNECT_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (CONNECT_TIMEOUT_MS % 1000) * 1000;
+
+        if (select(fd + 1, nullptr, &writable, nullptr, &timeout) == 1) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            connected = getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+        }
+    }
+    int64_t elapsedUs = esp_timer_get_time() - startUs;
+    close(fd);
+
+    if (!connected) {
+        server.dns->markStale();
+        return false;
+    }
+
+    rttMs = static_cast<uint32_t>((elapsedUs + 999) / 1000);
+    return true;
+}
@@ -0,0 +1,60 @@
+//BlynkServerSelector.hpp
+#pragma once
+
+#include "DnsCache.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Candidate Blynk servers (regional base URLs) ranked by measured round-trip
+// time. probeAll() times a TCP connect to each one, smoothing the result;
+// selectBest() picks the fastest healthy server, with a margin so traffic
+// does not flap between two similar ones. Each server keeps its own DNS cache.
+// Owned by the Blynk monitor task.
+class BlynkServerSelector {
+public:
+    static constexpr size_t MAX_SERVERS = 4;
+
+    struct ServerStatus {
+        const char* baseURL;
+        uint32_t rttMs;          // smoothed, 0 until measured
+        bool healthy;
+        uint32_t probes;
+        uint32_t probeFailures;
+    };
+
+    explicit BlynkServerSelector(uint32_t dnsTtlMs);
+
+    bool addServer(const std::string& baseURL);
+    size_t getServerCount() const;
+
+    void probeAll();
+    int selectBest(int current) const;
+    void markUnhealthy(int index);
+
+    const std::string& getBaseURL(int index) const;
+    DnsCache* getDnsCache(int index);
+    ServerStatus getStatus(int index) const;
+
+private:
+    static constexpr uint32_t CONNECT_TIMEOUT_MS = 2000;
+    static constexpr uint32_t SWITCH_MARGIN_PERCENT = 20;
+
+    struct Candidate {
+        std::string baseURL;
+        uint16_t port;
+        std::unique_ptr<DnsCache> dns;
+        uint32_t rttMs;
+        bool measured;
+        bool healthy;
+        uint32_t probes;
+        uint32_t probeFailures;
+    };
+
+    bool measureConnect(Candidate& server, uint32_t& rttMs);
+
+    uint32_t dnsTtlMs;
+    Candidate servers[MAX_SERVERS];
+    size_t serverCount;
+};
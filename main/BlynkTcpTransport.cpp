@@ -0,0 +1,433 @@
+//BlynkTcpTransport.cpp
+#include "BlynkTcpTransport.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+static const char* TAG = "BlynkTcpTransport";
+
+BlynkTcpTransport::BlynkTcpTransport(const std::string& host, uint16_t port, const std::string& authToken)
+    : host(host), port(port), authToken(authToken), pinWriteHandler(nullptr), connectedHandler(nullptr),
+      handlerContext(nullptr), sock(-1), connected(false), sendMutex(xSemaphoreCreateMutex()),
+      taskHandle(nullptr), msgCounter(0), loginMsgId(0), loginStatus(-1), lastSendMs(0),
+      lastReceiveMs(0), lastPingMs(0), pingMsgId(0), redirected(false), connects(0), loginFailures(0), redirects(0), pingTimeouts(0),
+      framesSent(0), framesReceived(0), bytesSent(0), roundTrips(0), lastRoundTripMs(0), rxBuffer{}, rxLength(0), txBuffer{} {
+    if (sendMutex == nullptr) {
+        ESP_LOGE(TAG, "Failed to create send mutex");
+    }
+}
+
+BlynkTcpTransport::~BlynkTcpTransport() {
+    if (taskHandle) {
+        vTaskDelete(taskHandle);
+        taskHandle = nullptr;
+    }
+    closeSocket();
+    if (sendMutex) {
+        vSemaphoreDelete(sendMutex);
+        sendMutex = nullptr;
+    }
+}
+
+const char* BlynkTcpTransport::getName() const {
+    return "TCP";
+}
+
+void BlynkTcpTransport::setHandlers(PinWriteHandler onPinWrite, ConnectedHandler onConnected, void* context) {
+    pinWriteHandler = onPinWrite;
+    connectedHandler = onConnected;
+    handlerContext = context;
+}
+
+esp_err_t BlynkTcpTransport::start() {
+    if (taskHandle) {
+        return ESP_OK;
+    }
+
+    if (sendMutex == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(transportTaskWrapper, "blynkTcpTask", TASK_STACK_SIZE, this, TASK_PRIORITY, &taskHandle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create blynkTcpTask");
+        taskHandle = nullptr;
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Blynk TCP transport started for %s:%u", host.c_str(), port);
+    return ESP_OK;
+}
+
+bool BlynkTcpTransport::isConnected() const {
+    return connected;
+}
+
+void BlynkTcpTransport::transportTaskWrapper(void* parameter) {
+    static_cast<BlynkTcpTransport*>(parameter)->transportTask();
+}
+
+void BlynkTcpTransport::transportTask() {
+    while (true) {
+        redirected = false;
+
+        if (connectSocket() && login()) {
+            connects++;
+            connected = true;
+            ESP_LOGI(TAG, "Logged in to %s:%u", host.c_str(), port);
+
+            if (connectedHandler) {
+                connectedHandler(handlerContext);
+            }
+
+            runSession();
+            connected = false;
+        }
+
+        closeSocket();
+        if (!redirected) {
+            vTaskDelay(pdMS_TO_TICKS(RECONNECT_DELAY_MS));
+        }
+    }
+}
+
+bool BlynkTcpTransport::connectSocket() {
+    char portStr[6];
+    snprintf(portStr, sizeof(portStr), "%u", port);
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+
+    int err = getaddrinfo(host.c_str(), portStr, &hints, &result);
+    if (err != 0 || result == nullptr) {
+        ESP_LOGE(TAG, "DNS lookup for %s failed: %d", host.c_str(), err);
+        return false;
+    }
+
+    int fd = socket(result->ai_family, result->ai_socktype, 0);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "Failed to create socket: errno %d", errno);
+        freeaddrinfo(result);
+        return false;
+    }
+
+    if (connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+        ESP_LOGW(TAG, "Connect to %s:%u failed: errno %d", host.c_str(), port, errno);
+        close(fd);
+        freeaddrinfo(result);
+        return false;
+    }
+    freeaddrinfo(result);
+
+    // Small frames must go out immediately, and recv() wakes up regularly for pings
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    struct timeval timeout = {};
+    timeout.tv_sec = RECV_TIMEOUT_MS / 1000;
+    timeout.tv_usec = (RECV_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (xSemaphoreTake(sendMutex, portMAX_DELAY) != pdTRUE) {
+        close(fd);
+        return false;
+    }
+    sock = fd;
+    rxLength = 0;
+    xSemaphoreGive(sendMutex);
+    return true;
+}
+
+bool BlynkTcpTransport::login() {
+    loginStatus = -1;
+    if (sendFrame(BlynkProtocol::CMD_HW_LOGIN, authToken, &loginMsgId) != ESP_OK) {
+        return false;
+    }
+
+    uint32_t startMs = nowMs();
+    while (loginStatus < 0 && nowMs() - startMs < LOGIN_TIMEOUT_MS) {
+        if (!receive()) {
+            break;
+        }
+    }
+
+    // A redirect during login is routine rerouting, counted on its own
+    if (redirected) {
+        return false;
+    }
+    if (loginStatus != BlynkProtocol::STATUS_SUCCESS) {
+        loginFailures++;
+        if (loginStatus == BlynkProtocol::STATUS_INVALID_TOKEN) {
+            ESP_LOGE(TAG, "Login rejected: invalid auth token");
+        } else {
+            ESP_LOGE(TAG, "Login failed (status %d)", loginStatus);
+        }
+        return false;
+    }
+
+    // Tell the server our heartbeat so it keeps the idle connection open
+    char info[48];
+    int length = snprintf(info, sizeof(info), "h-beat%c%lu%cbuff-in%c%u%cdev%cESP32",
+                          '\0', (unsigned long)HEARTBEAT_S, '\0', '\0', (unsigned)RX_BUFFER_SIZE, '\0', '\0');
+    sendFrame(BlynkProtocol::CMD_INTERNAL, std::string_view(info, length));
+    return true;
+}
+
+void BlynkTcpTransport::runSession() {
+    lastReceiveMs = nowMs();
+    lastPingMs = lastReceiveMs;
+
+    while (receive()) {
+        uint32_t now = nowMs();
+
+        if (now - lastReceiveMs > 2 * HEARTBEAT_S * 1000) {
+            pingTimeouts++;
+            ESP_LOGW(TAG, "No data from server for %lu s, reconnecting", (unsigned long)(2 * HEARTBEAT_S));
+            return;
+        }
+
+        // Ping when we have been silent, or when the server has (pushed writes are not acknowledged)
+        bool idle = now - lastSendMs >= HEARTBEAT_S * 1000;
+        bool quiet = now - lastReceiveMs >= HEARTBEAT_S * 1000 && now - lastPingMs >= HEARTBEAT_S * 1000;
+        if (idle || quiet) {
+            if (sendFrame(BlynkProtocol::CMD_PING, std::string_view(), &pingMsgId) != ESP_OK) {
+                return;
+            }
+            lastPingMs = now;
+        }
+    }
+}
+
+void BlynkTcpTransport::closeSocket() {
+    if (sendMutex == nullptr || xSemaphoreTake(sendMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    if (sock >= 0) {
+        close(sock);
+        sock = -1;
+    }
+    xSemaphoreGive(sendMutex);
+}
+
+bool BlynkTcpTransport::receive() {
+    if (rxLength >= RX_BUFFER_SIZE) {
+        ESP_LOGE(TAG, "Receive buffer overflow");
+        return false;
+    }
+
+    int received = recv(sock, rxBuffer + rxLength, RX_BUFFER_SIZE - rxLength, 0);
+    if (received == 0) {
+        ESP_LOGW(TAG, "Server closed the connection");
+        return false;
+    }
+    if (received < 0) {
+        // Timeout just gives the caller a chance to ping
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;
+        }
+        ESP_LOGW(TAG, "recv failed: errno %d", errno);
+        return false;
+    }
+
+    rxLength += received;
+    lastReceiveMs = nowMs();
+    return processFrames();
+}
+
+bool BlynkTcpTransport::processFrames() {
+    size_t offset = 0;
+    bool keepGoing = true;
+
+    while (keepGoing) {
+        BlynkProtocol::Header header;
+        if (!BlynkProtocol::decodeHeader(rxBuffer + offset, rxLength - offset, header)) {
+            break;
+        }
+
+        size_t bodyLength = header.command == BlynkProtocol::CMD_RESPONSE ? 0 : header.length;
+        if (BlynkProtocol::HEADER_SIZE + bodyLength > RX_BUFFER_SIZE) {
+            ESP_LOGE(TAG, "Frame of %u bytes does not fit the receive buffer", (unsigned)bodyLength);
+            return false;
+        }
+        if (rxLength - offset < BlynkProtocol::HEADER_SIZE + bodyLength) {
+            break;  // wait for the rest of the body
+        }
+
+        std::string_view body(reinterpret_cast<const char*>(rxBuffer + offset + BlynkProtocol::HEADER_SIZE), bodyLength);
+        framesReceived++;
+        keepGoing = handleFrame(header, body);
+        offset += BlynkProtocol::HEADER_SIZE + bodyLength;
+    }
+
+    // Keep a partial frame at the start of the buffer
+    memmove(rxBuffer, rxBuffer + offset, rxLength - offset);
+    rxLength -= offset;
+    return keepGoing;
+}
+
+bool BlynkTcpTransport::handleFrame(const BlynkProtocol::Header& header, std::string_view body) {
+    switch (header.command) {
+        case BlynkProtocol::CMD_RESPONSE:
+            if (header.msgId == loginMsgId && loginStatus < 0) {
+                loginStatus = header.length;
+            } else if (header.msgId == pingMsgId && header.length == BlynkProtocol::STATUS_SUCCESS) {
+                lastRoundTripMs = nowMs() - lastPingMs;
+                roundTrips++;
+            } else if (header.length != BlynkProtocol::STATUS_SUCCESS) {
+                ESP_LOGW(TAG, "Message %u answered with status %u", header.msgId, header.length);
+            }
+            return true;
+
+        case BlynkProtocol::CMD_PING:
+            return sendResponse(header.msgId, BlynkProtocol::STATUS_SUCCESS) == ESP_OK;
+
+        case BlynkProtocol::CMD_HARDWARE: {
+            int pin = -1;
+            std::string_view value;
+            if (!BlynkProtocol::parseVirtualWrite(body, pin, value)) {
+                ESP_LOGW(TAG, "Ignoring non virtual-write hardware message");
+                return true;
+            }
+            if (pinWriteHandler) {
+                pinWriteHandler(handlerContext, pin, value);
+            }
+            return true;
+        }
+
+        case BlynkProtocol::CMD_REDIRECT: {
+            // Body is "<host>\0<port>", the server wants us on another node
+            std::string_view fields = body;
+            std::string_view newHost = BlynkProtocol::nextField(fields);
+            std::string_view portField = BlynkProtocol::nextField(fields);
+            if (newHost.empty()) {
+                return true;
+            }
+
+            host.assign(newHost.data(), newHost.size());
+            uint16_t newPort = 0;
+            std::from_chars(portField.data(), portField.data() + portField.size(), newPort);
+            if (newPort > 0) {
+                port = newPort;
+            }
+            ESP_LOGI(TAG, "Redirected to %s:%u", host.c_str(), port);
+            redirects++;
+            redirected = true;
+            return false;
+        }
+
+        default:
+            // Internal/info messages are not used by this firmware
+            return true;
+    }
+}
+
+esp_err_t BlynkTcpTransport::virtualWrite(int pin, std::string_view value) {
+    if (!connected) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char body[TX_BUFFER_SIZE - BlynkProtocol::HEADER_SIZE];
+    size_t length = BlynkProtocol::buildVirtualWrite(body, sizeof(body), pin, value);
+    if (length == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return sendFrame(BlynkProtocol::CMD_HARDWARE, std::string_view(body, length));
+}
+
+esp_err_t BlynkTcpTransport::syncVirtual(const int* pins, size_t count) {
+    if (!connected) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char body[TX_BUFFER_SIZE - BlynkProtocol::HEADER_SIZE];
+    size_t length = BlynkProtocol::buildVirtualSync(body, sizeof(body), pins, count);
+    if (length == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return sendFrame(BlynkProtocol::CMD_HARDWARE_SYNC, std::string_view(body, length));
+}
+
+esp_err_t BlynkTcpTransport::sendFrame(uint8_t command, std::string_view body, uint16_t* msgId) {
+    if (sendMutex == nullptr || xSemaphoreTake(sendMutex, portMAX_DELAY) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint16_t id = nextMsgId();
+    size_t length = BlynkProtocol::encodeFrame(txBuffer, sizeof(txBuffer), command, id, body);
+    esp_err_t err = length > 0 ? sendRaw(txBuffer, length) : ESP_ERR_INVALID_SIZE;
+    xSemaphoreGive(sendMutex);
+
+    if (msgId) {
+        *msgId = id;
+    }
+    return err;
+}
+
+esp_err_t BlynkTcpTransport::sendResponse(uint16_t msgId, uint16_t status) {
+    if (sendMutex == nullptr || xSemaphoreTake(sendMutex, portMAX_DELAY) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t length = BlynkProtocol::encodeResponse(txBuffer, sizeof(txBuffer), msgId, status);
+    esp_err_t err = sendRaw(txBuffer, length);
+    xSemaphoreGive(sendMutex);
+    return err;
+}
+
+// Caller holds sendMutex
+esp_err_t BlynkTcpTransport::sendRaw(const uint8_t* data, size_t length) {
+    if (sock < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t sent = 0;
+    while (sent < length) {
+        int written = send(sock, data + sent, length - sent, 0);
+        if (written <= 0) {
+            ESP_LOGW(TAG, "send failed: errno %d", errno);
+            // Wakes the transport task's recv() so it reconnects
+            shutdown(sock, SHUT_RDWR);
+            return ESP_FAIL;
+        }
+        sent += written;
+    }
+
+    framesSent++;
+    bytesSent += length;
+    lastSendMs = nowMs();
+    return ESP_OK;
+}
+
+uint16_t BlynkTcpTransport::nextMsgId() {
+    // 0 is reserved for server-initiated messages
+    if (++msgCounter == 0) {
+        msgCounter = 1;
+    }
+    return msgCounter;
+}
+
+BlynkTcpTransport::Stats BlynkTcpTransport::getStats() const {
+    Stats stats = {};
+    stats.connects = connects;
+    stats.loginFailures = loginFailures;
+    stats.redirects = redirects;
+    stats.pingTimeouts = pingTimeouts;
+    stats.framesSent = framesSent;
+    stats.framesReceived = framesReceived;
+    stats.bytesSent = bytesSent;
+    stats.roundTrips = roundTrips;
+    stats.lastRoundTripMs = lastRoundTripMs;
+    return stats;
+}
+
+uint32_t BlynkTcpTransport::nowMs() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
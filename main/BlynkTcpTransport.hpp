@@ -0,0 +1,95 @@
+//BlynkTcpTransport.hpp
+#pragma once
+
+#include "BlynkProtocol.hpp"
+#include "BlynkPushTransport.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <atomic>
+#include <string>
+#include <string_view>
+
+// Persistent TCP connection speaking Blynk's hardware protocol. A dedicated
+// task connects, logs in, keeps the link alive with pings and reconnects on
+// failure; virtual pin writes from the app are pushed to the pin handler as
+// they arrive instead of being polled. Only POSIX sockets are used, so the
+// host/port can point at a local stand-in server during development.
+class BlynkTcpTransport : public BlynkPushTransport {
+public:
+    BlynkTcpTransport(const std::string& host, uint16_t port, const std::string& authToken);
+    ~BlynkTcpTransport() override;
+
+    const char* getName() const override;
+    void setHandlers(PinWriteHandler onPinWrite, ConnectedHandler onConnected, void* context) override;
+    esp_err_t start() override;
+    bool isConnected() const override;
+
+    esp_err_t virtualWrite(int pin, std::string_view value) override;
+    esp_err_t syncVirtual(const int* pins, size_t count) override;
+
+    Stats getStats() const override;
+
+private:
+    static constexpr uint32_t HEARTBEAT_S = 30;
+    static constexpr uint32_t RECV_TIMEOUT_MS = 1000;
+    static constexpr uint32_t LOGIN_TIMEOUT_MS = 5000;
+    static constexpr uint32_t RECONNECT_DELAY_MS = 5000;
+    static constexpr size_t RX_BUFFER_SIZE = 512;
+    static constexpr size_t TX_BUFFER_SIZE = 128;
+    static constexpr uint32_t TASK_STACK_SIZE = 4096;
+    static constexpr UBaseType_t TASK_PRIORITY = 3;
+
+    static void transportTaskWrapper(void* parameter);
+    void transportTask();
+    bool connectSocket();
+    bool login();
+    void runSession();
+    void closeSocket();
+    bool receive();
+    bool processFrames();
+    bool handleFrame(const BlynkProtocol::Header& header, std::string_view body);
+    esp_err_t sendFrame(uint8_t command, std::string_view body, uint16_t* msgId = nullptr);
+    esp_err_t sendResponse(uint16_t msgId, uint16_t status);
+    esp_err_t sendRaw(const uint8_t* data, size_t length);
+    uint16_t nextMsgId();
+    static uint32_t nowMs();
+
+    std::string host;
+    uint16_t port;
+    std::string authToken;
+    PinWriteHandler pinWriteHandler;
+    ConnectedHandler connectedHandler;
+    void* handlerContext;
+
+    int sock;
+    std::atomic<bool> connected;
+    SemaphoreHandle_t sendMutex;
+    TaskHandle_t taskHandle;
+    uint16_t msgCounter;
+
+    // Login / ping bookkeeping, owned by the transport task
+    uint16_t loginMsgId;
+    int loginStatus;
+    std::atomic<uint32_t> lastSendMs;  // also stamped by writers on other tasks
+    uint32_t lastReceiveMs;
+    uint32_t lastPingMs;
+    uint16_t pingMsgId;
+    bool redirected;
+
+    // Counters behind getStats(), read from other tasks
+    std::atomic<uint32_t> connects;
+    std::atomic<uint32_t> loginFailures;
+    std::atomic<uint32_t> redirects;
+    std::atomic<uint32_t> pingTimeouts;
+    std::atomic<uint32_t> framesSent;
+    std::atomic<uint32_t> framesReceived;
+    std::atomic<uint32_t> bytesSent;
+    std::atomic<uint32_t> roundTrips;
+    std::atomic<uint32_t> lastRoundTripMs;
+
+    uint8_t rxBuffer[RX_BUFFER_SIZE];
+    size_t rxLength;
+    uint8_t txBuffer[TX_BUFFER_SIZE];  // guarded by sendMutex
+};
@@ -0,0 +1,67 @@
+//CircuitBreaker.cpp
+#include "CircuitBreaker.hpp"
+
+CircuitBreaker::CircuitBreaker(uint32_t failureThreshold, uint32_t baseOpenMs, uint32_t maxOpenMs)
+    : failureThreshold(failureThreshold > 0 ? failureThreshold : 1), baseOpenMs(baseOpenMs),
+      maxOpenMs(maxOpenMs < baseOpenMs ? baseOpenMs : maxOpenMs), state(CLOSED),
+      openIntervalMs(baseOpenMs), reopenAtMs(0), stats{} {}
+
+CircuitBreaker::Decision CircuitBreaker::check(uint32_t nowMs) {
+    switch (state) {
+        case CLOSED:
+            return ALLOW;
+
+        case OPEN:
+            // Signed distance handles the 32-bit millisecond wrap
+            if (static_cast<int32_t>(nowMs - reopenAtMs) >= 0) {
+                state = HALF_OPEN;
+                stats.probes++;
+                return PROBE;
+            }
+            stats.rejected++;
+            return REJECT;
+
+        case HALF_OPEN:
+        default:
+            // Only the one probe until it reports back
+            stats.rejected++;
+            return REJECT;
+    }
+}
+
+void CircuitBreaker::recordSuccess() {
+    state = CLOSED;
+    openIntervalMs = baseOpenMs;
+    stats.consecutiveFailures = 0;
+}
+
+void CircuitBreaker::recordFailure(uint32_t nowMs) {
+    stats.consecutiveFailures++;
+
+    if (state == HALF_OPEN) {
+        // Probe failed, back off further
+        openIntervalMs = openIntervalMs > maxOpenMs / 2 ? maxOpenMs : openIntervalMs * 2;
+        open(nowMs);
+    } else if (state == CLOSED && stats.consecutiveFailures >= failureThreshold) {
+        openIntervalMs = baseOpenMs;
+        open(nowMs);
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::getState() const {
+    return state;
+}
+
+uint32_t CircuitBreaker::getOpenIntervalMs() const {
+    return openIntervalMs;
+}
+
+CircuitBreaker::Stats CircuitBreaker::getStats() const {
+    return stats;
+}
+
+void CircuitBreaker::open(uint32_t nowMs) {
+    state = OPEN;
+    reopenAtMs = nowMs + openIntervalMs;
+    stats.opens++;
+}
@@ -0,0 +1,54 @@
+//CircuitBreaker.hpp
+#pragma once
+
+#include <cstdint>
+
+// Fast-fail guard for a remote service. After `failureThreshold` consecutive
+// failures the breaker opens and rejects requests without touching the
+// network. Once the open interval expires a single probe is let through:
+// success closes the breaker, failure reopens it with the interval doubled
+// (up to maxOpenMs). Time is passed in, so the state machine has no IDF
+// dependencies and runs on a host as is. Not thread safe: the owner locks.
+class CircuitBreaker {
+public:
+    enum State : uint8_t {
+        CLOSED = 0,   // healthy, requests pass
+        OPEN,         // failing, requests rejected until the interval expires
+        HALF_OPEN     // one probe in flight
+    };
+
+    enum Decision : uint8_t {
+        ALLOW = 0,
+        PROBE,        // allowed, and the caller's result decides open/closed
+        REJECT
+    };
+
+    struct Stats {
+        uint32_t opens;
+        uint32_t rejected;
+        uint32_t probes;
+        uint32_t consecutiveFailures;
+    };
+
+    CircuitBreaker(uint32_t failureThreshold, uint32_t baseOpenMs, uint32_t maxOpenMs);
+
+    Decision check(uint32_t nowMs);
+    void recordSuccess();
+    void recordFailure(uint32_t nowMs);
+
+    State getState() const;
+    uint32_t getOpenIntervalMs() const;
+    Stats getStats() const;
+
+private:
+    void open(uint32_t nowMs);
+
+    uint32_t failureThreshold;
+    uint32_t baseOpenMs;
+    uint32_t maxOpenMs;
+
+    State state;
+    uint32_t openIntervalMs;
+    uint32_t reopenAtMs;
+    Stats stats;
+};
@@ -0,0 +1,78 @@
+//ClimateSource.hpp
+#pragma once
+
+#include "DeciValue.hpp"
+#include "VersionedSnapshot.hpp"
+#include "SensorBus.hpp"
+#include "esp_timer.h"
+#include <cstdint>
+
+// One reading as published by a sensor; always read as a whole, so the
+// values, their time and their sequence number belong together
+struct ClimateSample {
+    uint32_t sequence;      // 1 for the first sample, 0 if there is none yet
+    uint32_t timestampMs;   // monotonic (esp_timer) time the reading was taken
+    DeciCelsius temperature;
+    DeciPercent humidity;
+};
+
+// Room temperature/humidity as seen by the controller and the uploader:
+// a single DHTSensor, or a DHTSensorGroup fusing several of them. The
+// sensor task publishes each new reading; readers copy it lock-free, and
+// subscribers of getSampleBus() are told about it as it happens.
+class ClimateSource {
+public:
+    // Readings older than this count as no reading at all
+    static constexpr uint32_t DEFAULT_MAX_SAMPLE_AGE_MS = 10000;
+
+    virtual ~ClimateSource() = default;
+
+    // False before the first reading
+    bool getLatestSample(ClimateSample& sample) const {
+        latestSample.read(sample);
+        return sample.sequence != 0;
+    }
+
+    // Latest sample if it is at most maxAgeMs old; ageMs is set either way
+    // (UINT32_MAX if there is no sample)
+    bool getFreshSample(uint32_t maxAgeMs, ClimateSample& sample, uint32_t& ageMs) const {
+        if (!getLatestSample(sample)) {
+            ageMs = UINT32_MAX;
+            return false;
+        }
+        ageMs = nowMs() - sample.timestampMs;
+        return ageMs <= maxAgeMs;
+    }
+
+    // Adapters over the latest sample for logging and older callers
+    bool isReadSuccessful() const {
+        ClimateSample sample;
+        uint32_t ageMs;
+        return getFreshSample(DEFAULT_MAX_SAMPLE_AGE_MS, sample, ageMs);
+    }
+    DeciCelsius getTemperatureDeci() const { ClimateSample sample; getLatestSample(sample); return sample.temperature; }
+    DeciPercent getHumidityDeci() const { ClimateSample sample; getLatestSample(sample); return sample.humidity; }
+    float getTemperature() const { return getTemperatureDeci().toFloat(); }
+    float getHumidity() const { return getHumidityDeci().toFloat(); }
+
+    SensorBus& getSampleBus() { return sampleBus; }
+
+    static uint32_t nowMs() {
+        return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    }
+
+protected:
+    ClimateSource() : latestSample(ClimateSample{}), lastSequence(0) {}
+
+    // Called by the one task that takes readings
+    void publishSample(DeciCelsius temperature, DeciPercent humidity, uint32_t timestampMs) {
+        ClimateSample sample{ ++lastSequence, timestampMs, temperature, humidity };
+        latestSample.publish(sample);
+        sampleBus.publish(sample);
+    }
+
+private:
+    VersionedSnapshot<ClimateSample> latestSample;
+    uint32_t lastSequence;
+    SensorBus sampleBus;
+};
@@ -0,0 +1,35 @@
+//ControlConfig.hpp
+#pragma once
+
+#include "VersionedSnapshot.hpp"
+#include <cstdint>
+
+// App-controlled settings, published by BlynkManager once per poll cycle (or
+// per pushed write) and read by HumidifierController and PixelManager
+struct ControlConfig {
+    // Which fields have been received from Blynk so far
+    enum Field : uint16_t {
+        FIELD_MODE = 1 << 0,
+        FIELD_SWITCH = 1 << 1,
+        FIELD_THRESHOLD = 1 << 2,
+        FIELD_PIXEL_MODE = 1 << 3,
+        FIELD_BRIGHTNESS = 1 << 4,
+        FIELD_COLOUR = 1 << 5
+    };
+
+    uint16_t validFields;
+    bool autoMode;
+    bool manualSwitchOn;
+    float humidityThreshold;
+    uint8_t pixelMode;
+    uint8_t pixelBrightness;
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+
+    bool has(Field field) const {
+        return (validFields & field) != 0;
+    }
+};
+
+typedef VersionedSnapshot<ControlConfig> SharedControlConfig;
@@ -5,17 +5,32 @@
 
 static const char* TAG = "DHTSensor";
 
-DHTSensor::DHTSensor(gpio_num_t dhtPin): dhtControlPin(dhtPin), temperature(0.0f), humidity(0.0f), readSuccess(false){
+DHTSensor::DHTSensor(gpio_num_t dhtPin, CaptureMode mode): dhtControlPin(dhtPin), captureMode(mode), rmtHandle(nullptr), rawTemperature(0), rawHumidity(0),
+    scheduler(SAMPLE_PERIOD_MS, MIN_SAMPLE_SPACING_MS, MAX_RETRIES_PER_PERIOD), lastStatsLogMs(0){
+    setFilter(SensorFilter::median(DEFAULT_MEDIAN_WINDOW));
     //Initialize GPIO for dht sensor
     conf_DHTGPIO();
 }
 
-float DHTSensor::getTemperature() const{
-    return temperature;
+DeciCelsius DHTSensor::getRawTemperatureDeci() const{
+    return DeciCelsius::fromTenths(rawTemperature.load(std::memory_order_relaxed));
 }
 
-float DHTSensor::getHumidity() const{
-    return humidity;
+DeciPercent DHTSensor::getRawHumidityDeci() const{
+    return DeciPercent::fromTenths(rawHumidity.load(std::memory_order_relaxed));
+}
+
+float DHTSensor::getRawTemperature() const{
+    return getRawTemperatureDeci().toFloat();
+}
+
+float DHTSensor::getRawHumidity() const{
+    return getRawHumidityDeci().toFloat();
+}
+
+void DHTSensor::setFilter(const SensorFilter::Config& config){
+    temperatureFilter.configure(config);
+    humidityFilter.configure(config);
 }
 
 void DHTSensor::conf_DHTGPIO(){
@@ -35,11 +50,27 @@ void DHTSensor::conf_DHTGPIO(){
     }
 }
 
-bool DHTSensor::isReadSuccessful() const {
-    return readSuccess;
+DHTSensor::CaptureMode DHTSensor::getCaptureMode() const {
+    return captureMode;
+}
+
+SamplingScheduler::Stats DHTSensor::getSamplingStats() const {
+    return scheduler.getStats();
 }
 
 void DHTSensor::start(){
+    if(captureMode == CAPTURE_RMT && rmtHandle == nullptr){
+        esp_err_t err = dht_rmt_init(dhtControlPin, &rmtHandle);
+        if(err == ESP_OK){
+            ESP_LOGI(TAG, "DHT11 capture via RMT receiver");
+        }
+        else{
+            ESP_LOGW(TAG, "RMT capture unavailable (%s), using bit-banged reads", esp_err_to_name(err));
+            rmtHandle = nullptr;
+            captureMode = CAPTURE_BITBANG;
+        }
+    }
+
     BaseType_t result = xTaskCreate(
         dht_task,
         "dht_task",
@@ -58,35 +89,72 @@ void DHTSensor::start(){
 
 void DHTSensor::dht_task(void* pvParameters){
     DHTSensor* dhtController = static_cast<DHTSensor*>(pvParameters);
-    const TickType_t xDelay = pdMS_TO_TICKS(2000); //2 seconds
+    SamplingScheduler& scheduler = dhtController->scheduler;
+    scheduler.start(nowMs());
+    dhtController->lastStatsLogMs = nowMs();
+
+    // Reads happen on absolute slots, so the cadence no longer depends on
+    // how long reads take or how many of them fail
     while(true){
-        dhtController->DhtRead();
-        vTaskDelay(xDelay);
+        waitForSlot(scheduler.nextSlotMs());
+        uint32_t sampleMs = nowMs();
+        bool success = dhtController->DhtRead(sampleMs);
+        scheduler.recordAttempt(success, sampleMs);
+
+        if(sampleMs - dhtController->lastStatsLogMs >= STATS_LOG_INTERVAL_MS){
+            dhtController->lastStatsLogMs = sampleMs;
+            dhtController->logSamplingStats();
+        }
     }
 }
 
-void DHTSensor::DhtRead(){
-    const int maxTries = 3;
-    int attempt = 0;
-    esp_err_t result;
-    float temp, hum;
-
-    while(attempt < maxTries){
-        result = dht_read_float_data(DHT_TYPE_DHT11, dhtControlPin, &hum, &temp);
-        if(result == ESP_OK){
-            readSuccess = true;
-            temperature = temp;
-            humidity = hum;
-            ESP_LOGI(TAG, "DHT11 read success [Attempt %d]: Temp = %.2f °C, Humidity = %.2f%%", attempt+1, temperature, humidity);
-            return;
-        }
-        else{
-            readSuccess = false;
-            ESP_LOGW(TAG, "DHT11 read failed [Attempt %d]: %s", attempt + 1, esp_err_to_name(result));
-            vTaskDelay(pdMS_TO_TICKS(1000)); //Delay between retries
-        }
-        attempt++;
+void DHTSensor::waitForSlot(uint32_t slotMs){
+    int32_t remainingMs = (int32_t)(slotMs - nowMs());
+    if(remainingMs > 0){
+        // One extra tick, as the ms-to-tick conversion rounds down
+        vTaskDelay(pdMS_TO_TICKS(remainingMs) + 1);
     }
-    
-    ESP_LOGE(TAG, "DHT11 read failed after %d attempts", maxTries);
-}
\ No newline at end of file
+}
+
+bool DHTSensor::DhtRead(uint32_t sampleMs){
+    int16_t temp, hum;
+    esp_err_t result = readOnce(hum, temp);
+    if(result != ESP_OK){
+        ESP_LOGW(TAG, "DHT11 read failed: %s", esp_err_to_name(result));
+        return false;
+    }
+
+    // Integer tenths from the driver on, no float conversion
+    rawTemperature.store(temp, std::memory_order_relaxed);
+    rawHumidity.store(hum, std::memory_order_relaxed);
+    DeciCelsius temperature = DeciCelsius::fromTenths(temperatureFilter.update(temp));
+    DeciPercent humidity = DeciPercent::fromTenths(humidityFilter.update(hum));
+    publishSample(temperature, humidity, sampleMs);
+
+    char tempText[DECI_TEXT_SIZE], rawTempText[DECI_TEXT_SIZE], humText[DECI_TEXT_SIZE], rawHumText[DECI_TEXT_SIZE];
+    formatDeci(temperature.tenths, tempText, sizeof(tempText));
+    formatDeci(temp, rawTempText, sizeof(rawTempText));
+    formatDeci(humidity.tenths, humText, sizeof(humText));
+    formatDeci(hum, rawHumText, sizeof(rawHumText));
+    ESP_LOGI(TAG, "DHT11 read success: Temp = %s °C (raw %s), Humidity = %s%% (raw %s)",
+             tempText, rawTempText, humText, rawHumText);
+    return true;
+}
+
+void DHTSensor::logSamplingStats() const{
+    SamplingScheduler::Stats stats = scheduler.getStats();
+    ESP_LOGI(TAG, "Sampling: %lu samples, %lu attempts, retry rate %lu.%lu%%, %lu missed periods, %lu overruns",
+             (unsigned long)stats.samples, (unsigned long)stats.attempts,
+             (unsigned long)(stats.retryRatePermille / 10), (unsigned long)(stats.retryRatePermille % 10),
+             (unsigned long)stats.missedPeriods, (unsigned long)stats.overruns);
+    ESP_LOGI(TAG, "Sampling period: avg %lu ms, last %lu ms, jitter avg %lu ms, max %lu ms",
+             (unsigned long)stats.averagePeriodMs, (unsigned long)stats.lastPeriodMs,
+             (unsigned long)stats.averageJitterMs, (unsigned long)stats.maxJitterMs);
+}
+
+esp_err_t DHTSensor::readOnce(int16_t& hum, int16_t& temp){
+    if(captureMode == CAPTURE_RMT){
+        return dht_rmt_read_data(rmtHandle, DHT_TYPE_DHT11, &hum, &temp);
+    }
+    return dht_read_data(DHT_TYPE_DHT11, dhtControlPin, &hum, &temp);
+}
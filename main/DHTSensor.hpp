@@ -3,29 +3,63 @@
 
 #include "driver/gpio.h"
 #include "pinDefinitions.hpp"
+#include "ClimateSource.hpp"
+#include "SensorFilter.hpp"
+#include "SamplingScheduler.hpp"
 #include "dht.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <atomic>
 
 extern "C" {
     #include "dht.h"
 }
 
-class DHTSensor {
+class DHTSensor : public ClimateSource {
 public: 
+    // How the sensor reply is captured. RMT times the bits in hardware and
+    // keeps interrupts enabled; BITBANG is the original busy-wait read,
+    // which runs ~25 ms inside a critical section.
+    enum CaptureMode {
+        CAPTURE_BITBANG = 0,
+        CAPTURE_RMT
+    };
+
     void start();  //starts freeRTOS tasks
-    float getTemperature() const;
-    float getHumidity() const;
+    // Filtered readings are published as ClimateSource samples; the raw
+    // ones are the last reading as delivered
+    DeciCelsius getRawTemperatureDeci() const;
+    DeciPercent getRawHumidityDeci() const;
+    float getRawTemperature() const;
+    float getRawHumidity() const;
+    // Smoothing applied to both channels (median of 3 by default); call before start()
+    void setFilter(const SensorFilter::Config& config);
     
-    explicit DHTSensor(gpio_num_t dhtPin);  //Constructor with dhtControlPin
-    bool isReadSuccessful() const;
+    explicit DHTSensor(gpio_num_t dhtPin, CaptureMode mode = CAPTURE_RMT);  //Constructor with dhtControlPin
+    CaptureMode getCaptureMode() const;
+    // Achieved sampling period, jitter and retry rate since start()
+    SamplingScheduler::Stats getSamplingStats() const;
 
 private:
+    static constexpr uint8_t DEFAULT_MEDIAN_WINDOW = 3;
+    static constexpr uint32_t SAMPLE_PERIOD_MS = 2000;
+    static constexpr uint32_t MIN_SAMPLE_SPACING_MS = 1000;  // DHT11 limit between reads
+    static constexpr uint32_t MAX_RETRIES_PER_PERIOD = 1;
+    static constexpr uint32_t STATS_LOG_INTERVAL_MS = 300000;
     static void dht_task(void* pvParameters);
-    void DhtRead();
+    static void waitForSlot(uint32_t slotMs);
+    bool DhtRead(uint32_t sampleMs);  //one attempt, no retries
+    void logSamplingStats() const;
+    esp_err_t readOnce(int16_t& hum, int16_t& temp);
     gpio_num_t dhtControlPin;  //Stores GPIO pin
-    float temperature;
-    float humidity;
-    bool readSuccess;
+    CaptureMode captureMode;
+    dht_rmt_handle_t rmtHandle;  //null until start() in RMT mode
+    // Last raw reading in tenths; written by the sensor task, read from any task
+    std::atomic<int16_t> rawTemperature;
+    std::atomic<int16_t> rawHumidity;
+    SensorFilter temperatureFilter;
+    SensorFilter humidityFilter;
+    SamplingScheduler scheduler;
+    uint32_t lastStatsLogMs;
     void conf_DHTGPIO();
 };
\ No newline at end of file
@@ -0,0 +1,189 @@
+//DHTSensorGroup.cpp
+#include "DHTSensorGroup.hpp"
+#include "esp_log.h"
+#include <algorithm>
+
+static const char* TAG = "DHTSensorGroup";
+
+static_assert(DHTSensorGroup::MAX_SENSORS > 0, "Group needs at least one sensor slot");
+
+// Integer division rounded half away from zero
+static int32_t divideRounded(int32_t sum, int32_t count) {
+    return sum >= 0 ? (sum + count / 2) / count : (sum - count / 2) / count;
+}
+
+DHTSensorGroup::DHTSensorGroup(FusionMethod method)
+    : fusionMethod(method), channels{}, sensorCount(0), healthyCount(0) {
+    stateMutex = xSemaphoreCreateMutex();
+}
+
+bool DHTSensorGroup::addSensor(gpio_num_t pin) {
+    if (sensorCount >= MAX_SENSORS) {
+        ESP_LOGE(TAG, "Group full, GPIO %d not added", pin);
+        return false;
+    }
+
+    Channel& channel = channels[sensorCount];
+    channel.pin = pin;
+    channel.rmtHandle = nullptr;
+    channel.health = {};
+    channel.health.pin = pin;
+
+    esp_err_t err = dht_rmt_init(pin, &channel.rmtHandle);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "GPIO %d: RMT capture unavailable (%s), using bit-banged reads", pin, esp_err_to_name(err));
+        channel.rmtHandle = nullptr;
+    }
+
+    ++sensorCount;
+    return true;
+}
+
+void DHTSensorGroup::start() {
+    if (sensorCount == 0) {
+        ESP_LOGE(TAG, "No sensors added, not starting");
+        return;
+    }
+
+    BaseType_t result = xTaskCreate(
+        sweepTask,
+        "dht_group_task",
+        4096,
+        this,
+        1,
+        nullptr);
+
+    if (result != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create dht_group_task");
+    }
+    else {
+        ESP_LOGI(TAG, "Reading %d sensors, one every %lu ms", sensorCount,
+                 (unsigned long)(SWEEP_PERIOD_MS / sensorCount));
+    }
+}
+
+int DHTSensorGroup::getSensorCount() const {
+    return sensorCount;
+}
+
+int DHTSensorGroup::getHealthyCount() const {
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    int count = healthyCount;
+    xSemaphoreGive(stateMutex);
+    return count;
+}
+
+bool DHTSensorGroup::getSensorHealth(int index, SensorHealth& health) const {
+    if (index < 0 || index >= sensorCount) {
+        return false;
+    }
+
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    health = channels[index].health;
+    xSemaphoreGive(stateMutex);
+    return true;
+}
+
+void DHTSensorGroup::sweepTask(void* pvParameters) {
+    DHTSensorGroup* group = static_cast<DHTSensorGroup*>(pvParameters);
+    // Each sensor gets its own slot, so it is read exactly once per sweep
+    // however many sensors share the task
+    static_assert(SWEEP_PERIOD_MS >= MIN_SENSOR_INTERVAL_MS, "Sweep faster than the DHT11 allows");
+    const TickType_t slotTicks = pdMS_TO_TICKS(SWEEP_PERIOD_MS / group->sensorCount);
+    TickType_t lastWake = xTaskGetTickCount();
+
+    while (true) {
+        for (int i = 0; i < group->sensorCount; ++i) {
+            bool newReading = group->readChannel(group->channels[i]);
+            group->fuse(newReading);
+            vTaskDelayUntil(&lastWake, slotTicks);
+        }
+    }
+}
+
+bool DHTSensorGroup::readChannel(Channel& channel) {
+    int16_t hum, temp;
+    esp_err_t result;
+    if (channel.rmtHandle != nullptr) {
+        result = dht_rmt_read_data(channel.rmtHandle, DHT_TYPE_DHT11, &hum, &temp);
+    }
+    else {
+        result = dht_read_data(DHT_TYPE_DHT11, channel.pin, &hum, &temp);
+    }
+    uint32_t readMs = nowMs();
+
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    SensorHealth& health = channel.health;
+    ++health.reads;
+    if (result == ESP_OK) {
+        health.temperature = DeciCelsius::fromTenths(temp);
+        health.humidity = DeciPercent::fromTenths(hum);
+        health.lastSuccessMs = readMs;
+        health.consecutiveFailures = 0;
+    }
+    else {
+        ++health.failures;
+        ++health.consecutiveFailures;
+    }
+    xSemaphoreGive(stateMutex);
+
+    if (result != ESP_OK && health.consecutiveFailures == UNHEALTHY_AFTER_FAILURES) {
+        ESP_LOGW(TAG, "GPIO %d stopped answering: %s", channel.pin, esp_err_to_name(result));
+    }
+    return result == ESP_OK;
+}
+
+void DHTSensorGroup::fuse(bool newReading) {
+    uint32_t now = nowMs();
+    int16_t temperatures[MAX_SENSORS];
+    int16_t humidities[MAX_SENSORS];
+    uint32_t newestMs = 0;
+    int count = 0;
+
+    xSemaphoreTake(stateMutex, portMAX_DELAY);
+    for (int i = 0; i < sensorCount; ++i) {
+        SensorHealth& health = channels[i].health;
+        health.healthy = health.lastSuccessMs != 0
+                      && health.consecutiveFailures < UNHEALTHY_AFTER_FAILURES
+                      && now - health.lastSuccessMs <= STALE_AFTER_MS;
+        if (health.healthy) {
+            temperatures[count] = health.temperature.tenths;
+            humidities[count] = health.humidity.tenths;
+            if (count == 0 || now - health.lastSuccessMs < now - newestMs) {
+                newestMs = health.lastSuccessMs;
+            }
+            ++count;
+        }
+    }
+    healthyCount = count;
+    xSemaphoreGive(stateMutex);
+
+    // A failed read leaves the last sample standing; it goes stale on its own
+    if (count > 0 && newReading) {
+        DeciCelsius fusedTemperature = DeciCelsius::fromTenths(fuseValues(temperatures, count));
+        DeciPercent fusedHumidity = DeciPercent::fromTenths(fuseValues(humidities, count));
+        publishSample(fusedTemperature, fusedHumidity, newestMs);
+
+        char tempText[DECI_TEXT_SIZE], humText[DECI_TEXT_SIZE];
+        formatDeci(fusedTemperature.tenths, tempText, sizeof(tempText));
+        formatDeci(fusedHumidity.tenths, humText, sizeof(humText));
+        ESP_LOGD(TAG, "Fused %d/%d sensors: Temp = %s °C, Humidity = %s%%", count, sensorCount, tempText, humText);
+    }
+}
+
+int32_t DHTSensorGroup::fuseValues(int16_t* values, int count) const {
+    std::sort(values, values + count);
+
+    if (fusionMethod == FUSE_TRIMMED_MEAN && count >= 3) {
+        int32_t sum = 0;
+        for (int i = 1; i < count - 1; ++i) {
+            sum += values[i];
+        }
+        return divideRounded(sum, count - 2);
+    }
+
+    if (count % 2 == 1) {
+        return values[count / 2];
+    }
+    return divideRounded(values[count / 2 - 1] + values[count / 2], 2);
+}
@@ -0,0 +1,74 @@
+//DHTSensorGroup.hpp
+#pragma once
+
+#include "ClimateSource.hpp"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+extern "C" {
+    #include "dht.h"
+}
+
+// Several DHT11s on one board, read by a single task and reported as one
+// fused value. Reads are staggered over the sweep so the bus is never busy
+// for more than one sensor at a time, and each sensor is read once per
+// sweep. Storage is fixed at MAX_SENSORS, so adding sensors costs no heap
+// and no extra task.
+class DHTSensorGroup : public ClimateSource {
+public:
+    static constexpr int MAX_SENSORS = 4;
+
+    enum FusionMethod {
+        FUSE_MEDIAN = 0,
+        FUSE_TRIMMED_MEAN   // mean without the highest and lowest value
+    };
+
+    struct SensorHealth {
+        gpio_num_t pin;
+        bool healthy;                  // answering and not stale
+        uint32_t reads;
+        uint32_t failures;
+        uint32_t consecutiveFailures;
+        uint32_t lastSuccessMs;        // 0 if never read
+        DeciCelsius temperature;       // last good reading
+        DeciPercent humidity;
+    };
+
+    explicit DHTSensorGroup(FusionMethod method = FUSE_MEDIAN);
+
+    // Call before start(); returns false when the group is full
+    bool addSensor(gpio_num_t pin);
+    void start();
+
+    // Samples are fused over the healthy sensors (each at most STALE_AFTER_MS
+    // old) and stamped with the reading that triggered them
+    int getSensorCount() const;
+    int getHealthyCount() const;
+    bool getSensorHealth(int index, SensorHealth& health) const;
+
+private:
+    static constexpr uint32_t SWEEP_PERIOD_MS = 2000;      // per-sensor read interval
+    static constexpr uint32_t MIN_SENSOR_INTERVAL_MS = 1000; // DHT11 limit
+    static constexpr uint32_t UNHEALTHY_AFTER_FAILURES = 3;
+    static constexpr uint32_t STALE_AFTER_MS = 10000;
+
+    struct Channel {
+        gpio_num_t pin;
+        dht_rmt_handle_t rmtHandle;    // null: bit-banged reads
+        SensorHealth health;
+    };
+
+    FusionMethod fusionMethod;
+    Channel channels[MAX_SENSORS];
+    int sensorCount;
+
+    SemaphoreHandle_t stateMutex;  // guards channel health
+    int healthyCount;
+
+    static void sweepTask(void* pvParameters);
+    bool readChannel(Channel& channel);
+    void fuse(bool newReading);
+    int32_t fuseValues(int16_t* values, int count) const;
+};
@@ -0,0 +1,74 @@
+//DeciValue.hpp
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+
+// Float to tenths, rounded half away from zero
+constexpr int32_t toTenths(float value) {
+    return static_cast<int32_t>(value >= 0.0f ? value * 10.0f + 0.5f : value * 10.0f - 0.5f);
+}
+
+// Sensor value in tenths of a unit, the DHT driver's native format. The tag
+// keeps degrees and percents from being mixed up; float is only used at the
+// edges (logging, user-entered thresholds) through toFloat()/fromFloat().
+template <typename Unit>
+struct DeciValue {
+    int16_t tenths;
+
+    static constexpr DeciValue fromTenths(int32_t value) {
+        return DeciValue{ static_cast<int16_t>(value) };
+    }
+
+    static constexpr DeciValue fromFloat(float value) {
+        return DeciValue{ static_cast<int16_t>(toTenths(value)) };
+    }
+
+    constexpr float toFloat() const {
+        return tenths / 10.0f;
+    }
+
+    friend constexpr auto operator<=>(DeciValue a, DeciValue b) = default;
+};
+
+struct CelsiusUnit {};
+struct PercentUnit {};
+
+typedef DeciValue<CelsiusUnit> DeciCelsius;
+typedef DeciValue<PercentUnit> DeciPercent;
+
+// Longest formatted value: "-3276.8" plus the terminator
+constexpr size_t DECI_TEXT_SIZE = 8;
+
+// Writes tenths as decimal text, "45", "-0.5" or "23.4" (no ".0" for whole
+// values), NUL terminated. Returns the length, or 0 if the buffer is too small.
+inline size_t formatDeci(int32_t tenths, char* buffer, size_t size) {
+    char digits[12];
+    size_t count = 0;
+    bool negative = tenths < 0;
+    uint32_t magnitude = negative ? 0u - static_cast<uint32_t>(tenths) : static_cast<uint32_t>(tenths);
+
+    uint32_t fraction = magnitude % 10;
+    uint32_t whole = magnitude / 10;
+    if (fraction != 0) {
+        digits[count++] = static_cast<char>('0' + fraction);
+        digits[count++] = '.';
+    }
+    do {
+        digits[count++] = static_cast<char>('0' + whole % 10);
+        whole /= 10;
+    } while (whole != 0);
+    if (negative) {
+        digits[count++] = '-';
+    }
+
+    if (count + 1 > size) {
+        return 0;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        buffer[i] = digits[count - 1 - i];
+    }
+    buffer[count] = '\0';
+    return count;
+}
@@ -0,0 +1,123 @@
+//DnsCache.cpp
+#include "DnsCache.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static const char* TAG = "DnsCache";
+
+DnsCache::DnsCache(const std::string& host, uint32_t ttlMs)
+    : host(host), ttlMs(ttlMs), address(0), resolvedAtMs(0), stale(false), resolveMutex(xSemaphoreCreateMutex()), hits(0), misses(0),
+      resolutions(0), failures(0), lastLatencyMs(0), maxLatencyMs(0), totalLatencyMs(0) {
+    if (resolveMutex == nullptr) {
+        ESP_LOGE(TAG, "Failed to create resolve mutex");
+    }
+}
+
+bool DnsCache::getAddress(char* buffer, size_t size) {
+    uint32_t cached = address;
+    if (cached != 0 && nowMs() - resolvedAtMs < ttlMs) {
+        hits++;
+    } else {
+        misses++;
+        if (!resolve()) {
+            return false;
+        }
+        cached = address;
+    }
+
+    struct in_addr addr = {};
+    addr.s_addr = cached;
+    return inet_ntop(AF_INET, &addr, buffer, size) != nullptr;
+}
+
+void DnsCache::refresh() {
+    uint32_t age = nowMs() - resolvedAtMs;
+    bool due = address == 0 || stale || age >= ttlMs / 100 * REFRESH_PERCENT;
+    if (due) {
+        resolve();
+    }
+}
+
+void DnsCache::markStale() {
+    stale = true;
+}
+
+const std::string& DnsCache::getHost() const {
+    return host;
+}
+
+DnsCache::Stats DnsCache::getStats() const {
+    Stats stats = {};
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.resolutions = resolutions;
+    stats.failures = failures;
+    stats.lastLatencyMs = lastLatencyMs;
+    stats.maxLatencyMs = maxLatencyMs;
+    stats.averageLatencyMs = stats.resolutions > 0 ? totalLatencyMs / stats.resolutions : 0;
+    return stats;
+}
+
+bool DnsCache::resolve() {
+    // The request path and refresh() can both get here; whoever comes second
+    // waits and takes the first lookup's result instead of resolving again
+    uint32_t seenResolutions = resolutions;
+    uint32_t seenFailures = failures;
+    if (resolveMutex == nullptr || xSemaphoreTake(resolveMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    if (resolutions != seenResolutions || failures != seenFailures) {
+        bool resolved = resolutions != seenResolutions;
+        xSemaphoreGive(resolveMutex);
+        return resolved;
+    }
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+
+    uint32_t startMs = nowMs();
+    int err = getaddrinfo(host.c_str(), nullptr, &hints, &result);
+    uint32_t latencyMs = nowMs() - startMs;
+
+    if (err != 0 || result == nullptr) {
+        failures++;
+        xSemaphoreGive(resolveMutex);
+        // Keep serving the old address until the TTL runs out
+        ESP_LOGW(TAG, "Resolving %s failed: %d (%lu ms)", host.c_str(), err, (unsigned long)latencyMs);
+        return false;
+    }
+
+    uint32_t resolved = reinterpret_cast<struct sockaddr_in*>(result->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(result);
+
+    uint32_t previous = address.exchange(resolved);
+    resolvedAtMs = nowMs();
+    stale = false;
+
+    resolutions++;
+    lastLatencyMs = latencyMs;
+    totalLatencyMs += latencyMs;
+    if (latencyMs > maxLatencyMs) {
+        maxLatencyMs = latencyMs;
+    }
+    xSemaphoreGive(resolveMutex);
+
+    if (previous != resolved) {
+        char text[16];
+        struct in_addr addr = {};
+        addr.s_addr = resolved;
+        inet_ntop(AF_INET, &addr, text, sizeof(text));
+        ESP_LOGI(TAG, "%s -> %s (%lu ms)", host.c_str(), text, (unsigned long)latencyMs);
+    }
+    return true;
+}
+
+uint32_t DnsCache::nowMs() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
@@ -0,0 +1,63 @@
+//DnsCache.hpp
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Caches the IPv4 address of one host so requests connect by IP instead of
+// resolving on every connection. lwIP does not report record TTLs, so a fixed
+// TTL is used; refresh() re-resolves ahead of expiry (or after markStale())
+// from a background task, and the request path only resolves itself on a
+// miss. Address and stamps are atomics, hits never block; lookups are
+// serialized, so a miss during a refresh waits for it and uses its result.
+class DnsCache {
+public:
+    struct Stats {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t resolutions;
+        uint32_t failures;
+        uint32_t lastLatencyMs;
+        uint32_t maxLatencyMs;
+        uint32_t averageLatencyMs;
+    };
+
+    DnsCache(const std::string& host, uint32_t ttlMs);
+
+    // Writes the cached address as dotted text; resolves first on a miss
+    bool getAddress(char* buffer, size_t size);
+
+    // Re-resolves when the entry is missing, stale or past REFRESH_PERCENT of its TTL
+    void refresh();
+    // Connection failed: the address may have moved, re-resolve on next refresh()
+    void markStale();
+
+    const std::string& getHost() const;
+    Stats getStats() const;
+
+private:
+    static constexpr uint32_t REFRESH_PERCENT = 80;
+
+    bool resolve();
+    static uint32_t nowMs();
+
+    std::string host;
+    uint32_t ttlMs;
+
+    std::atomic<uint32_t> address;       // network byte order, 0 = none
+    std::atomic<uint32_t> resolvedAtMs;
+    std::atomic<bool> stale;
+    SemaphoreHandle_t resolveMutex;  // one getaddrinfo() at a time
+
+    std::atomic<uint32_t> hits;
+    std::atomic<uint32_t> misses;
+    std::atomic<uint32_t> resolutions;
+    std::atomic<uint32_t> failures;
+    std::atomic<uint32_t> lastLatencyMs;
+    std::atomic<uint32_t> maxLatencyMs;
+    std::atomic<uint32_t> totalLatencyMs;
+};
@@ -0,0 +1,58 @@
+//HeapMonitor.cpp
+#include "HeapMonitor.hpp"
+#include "sdkconfig.h"
+#include "esp_log.h"
+
+static const char* TAG = "HeapMonitor";
+
+std::atomic<TaskHandle_t> HeapMonitor::watchedTasks[MAX_WATCHED_TASKS] = {};
+std::atomic<uint32_t> HeapMonitor::allocationCount(0);
+
+bool HeapMonitor::isAvailable() {
+#ifdef CONFIG_HEAP_USE_HOOKS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HeapMonitor::watchCurrentTask() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    for (int i = 0; i < MAX_WATCHED_TASKS; ++i) {
+        TaskHandle_t expected = nullptr;
+        if (watchedTasks[i].load() == self
+            || watchedTasks[i].compare_exchange_strong(expected, self)) {
+            return;
+        }
+    }
+
+    ESP_LOGW(TAG, "No free slot to watch task %p", self);
+}
+
+uint32_t HeapMonitor::takeAllocationCount() {
+    return allocationCount.exchange(0);
+}
+
+void HeapMonitor::onAllocation() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (self == nullptr) {
+        return;
+    }
+
+    for (int i = 0; i < MAX_WATCHED_TASKS; ++i) {
+        if (watchedTasks[i].load(std::memory_order_relaxed) == self) {
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    HeapMonitor::onAllocation();
+}
+
+extern "C" void esp_heap_trace_free_hook(void* ptr) {
+}
+#endif
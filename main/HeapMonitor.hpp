@@ -0,0 +1,26 @@
+//HeapMonitor.hpp
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+
+// Counts heap allocations made from a small set of watched tasks, so a hot
+// loop can verify it runs without malloc. Counting relies on the IDF heap
+// hooks (CONFIG_HEAP_USE_HOOKS); without them the count always stays 0.
+class HeapMonitor {
+public:
+    static bool isAvailable();
+    static void watchCurrentTask();
+
+    // Allocations made by watched tasks since the previous call
+    static uint32_t takeAllocationCount();
+
+    static void onAllocation();  // called from the heap hook
+
+private:
+    static constexpr int MAX_WATCHED_TASKS = 4;
+
+    static std::atomic<TaskHandle_t> watchedTasks[MAX_WATCHED_TASKS];
+    static std::atomic<uint32_t> allocationCount;
+};
@@ -1,13 +1,17 @@
 //HumidifierController.cpp
 #include "HumidifierController.hpp"
-#include "DHTSensor.hpp"
+#include "ClimateSource.hpp"
 #include "BlynkManager.hpp"
 #include "esp_log.h"
 
 static const char* TAG = "HUMIDIFIER";
 
-HumidifierController::HumidifierController(DHTSensor* dhtSensor, BlynkManager* blynkManager, gpio_num_t humPin) 
-    : dhtSensor(dhtSensor), blynkManager(blynkManager), humControlPin(humPin), humidifierState(false) {
+static constexpr DeciPercent MIN_HUMIDITY = DeciPercent::fromTenths(0);
+static constexpr DeciPercent MAX_HUMIDITY = DeciPercent::fromTenths(1000);
+
+HumidifierController::HumidifierController(ClimateSource* climateSource, BlynkManager* blynkManager, gpio_num_t humPin) 
+    : climateSource(climateSource), blynkManager(blynkManager), humControlPin(humPin), humidifierState(false), controlTaskHandle(nullptr),
+      decisionStats{}, totalSampleAgeMs(0) {
     //Initialize GPIO pin for Humidifier
     conf_HumidifierGPIO();
 }
@@ -49,20 +53,65 @@ bool HumidifierController::getState() const {
     return humidifierState;
 }
 
-void HumidifierController::setHumidityThreshold(float threshold){
-    if(threshold >= 0.0f && threshold <= 100.0f){
+void HumidifierController::setHumidityThreshold(DeciPercent threshold){
+    char text[DECI_TEXT_SIZE];
+    formatDeci(threshold.tenths, text, sizeof(text));
+    if(threshold >= MIN_HUMIDITY && threshold <= MAX_HUMIDITY){
         humidityThreshold = threshold;
-        ESP_LOGI(TAG, "Humidity threshold updated to %.2f%%", humidityThreshold);
+        ESP_LOGI(TAG, "Humidity threshold updated to %s%%", text);
     }
     else{
-        ESP_LOGW(TAG, "Invalid humidity threshold value: %.2f, ignoring", threshold);
+        ESP_LOGW(TAG, "Invalid humidity threshold value: %s, ignoring", text);
     }
 }
 
-float HumidifierController::getHumidityThreshold() const {
+DeciPercent HumidifierController::getHumidityThresholdDeci() const {
     return humidityThreshold;
 }
 
+void HumidifierController::setHumidityThreshold(float threshold){
+    setHumidityThreshold(DeciPercent::fromFloat(threshold));
+}
+
+float HumidifierController::getHumidityThreshold() const {
+    return humidityThreshold.toFloat();
+}
+
+HumidifierController::DecisionStats HumidifierController::getDecisionStats() const {
+    DecisionStats stats = decisionStats;
+    stats.averageSampleAgeMs = decisionStats.decisions > 0 ? (uint32_t)(totalSampleAgeMs / decisionStats.decisions) : 0;
+    return stats;
+}
+
+void HumidifierController::recordDecision(const ClimateSample& sample, uint32_t sampleAgeMs){
+    decisionStats.decisions++;
+    if(sample.sequence != decisionStats.lastSequence){
+        decisionStats.newSamples++;
+        decisionStats.lastSequence = sample.sequence;
+    }
+    decisionStats.lastSampleAgeMs = sampleAgeMs;
+    totalSampleAgeMs += sampleAgeMs;
+    if(sampleAgeMs > decisionStats.maxSampleAgeMs){
+        decisionStats.maxSampleAgeMs = sampleAgeMs;
+    }
+}
+
+void HumidifierController::recordStaleDecision(){
+    decisionStats.staleFallbacks++;
+}
+
+void HumidifierController::notifyControlChanged(){
+    if(controlTaskHandle != nullptr){
+        xTaskNotify(controlTaskHandle, NOTIFY_CONTROL_CHANGED, eSetBits);
+    }
+}
+
+void HumidifierController::notifyCloudStateChanged(){
+    if(controlTaskHandle != nullptr){
+        xTaskNotify(controlTaskHandle, NOTIFY_CLOUD_STATE, eSetBits);
+    }
+}
+
 void HumidifierController::start(){
     //pass the current instance as pvParameters
     BaseType_t result = xTaskCreate(
@@ -71,54 +120,94 @@ void HumidifierController::start(){
         4096,
         this,
         1,
-        nullptr);
+        &controlTaskHandle);
 
     if(result != pdPASS){
         ESP_LOGE(TAG, "Failed to create HMD_controlTask");
+        return;
     }
-    else{
-        ESP_LOGI(TAG, "Successfully created HMD_controlTask");
-    }
+    ESP_LOGI(TAG, "Successfully created HMD_controlTask");
+
+    // Decide when a new reading arrives rather than on a timer of our own
+    climateSource->getSampleBus().subscribe(onNewSample, this);
+}
+
+void HumidifierController::onNewSample(void* context, const ClimateSample& sample){
+    HumidifierController* controller = static_cast<HumidifierController*>(context);
+    xTaskNotify(controller->controlTaskHandle, NOTIFY_NEW_SAMPLE, eSetBits);
 }
 
 void HumidifierController::HMD_ControlTask(void* pvParameters){
     //cast the pointer back to HumidifierController instance
     HumidifierController* controller = static_cast<HumidifierController*>(pvParameters);
-    const TickType_t xDelay = pdMS_TO_TICKS(2000);
+    const SharedControlConfig& sharedConfig = controller->blynkManager->getControlConfig();
+    ControlConfig config = {};
+    uint32_t seenVersion = 0;
+    bool firstRead = true;
+    bool cloudReachable = true;
 
     while(true){
-        // Check if we're in auto or manual mode
-        bool isAutoMode = controller->blynkManager->isAutoMode();
-        
+        // Mode, switch and threshold always come from the same Blynk cycle
+        if(firstRead || sharedConfig.getVersion() != seenVersion){
+            seenVersion = sharedConfig.read(config);
+            firstRead = false;
+            // Converted once per config change; the control loop compares integers
+            DeciPercent threshold = DeciPercent::fromFloat(config.humidityThreshold);
+            if(config.has(ControlConfig::FIELD_THRESHOLD) && threshold != controller->humidityThreshold){
+                controller->setHumidityThreshold(threshold);
+            }
+        }
+
+        // Mode and switch are the last values received; while Blynk is
+        // unreachable they can't change, so manual mode holds its output
+        bool isAutoMode = config.autoMode;
+        bool reachable = controller->blynkManager->isCloudReachable();
+        if (reachable != cloudReachable) {
+            cloudReachable = reachable;
+            if (!cloudReachable) {
+                ESP_LOGW(TAG, "[OFFLINE] Blynk unreachable, keeping the last %s setting", isAutoMode ? "auto" : "manual");
+            } else {
+                ESP_LOGI(TAG, "Blynk reachable again");
+            }
+        }
+
         if (isAutoMode) {
-            // AUTO MODE: Control based on sensor readings and threshold
-            if(!controller->dhtSensor->isReadSuccessful()){
-                ESP_LOGE(TAG, "Failed to read temperature from DHT sensor!");
+            // AUTO MODE: Control based on the freshest sensor sample and threshold
+            ClimateSample sample;
+            uint32_t sampleAgeMs = 0;
+            if(!controller->climateSource->getFreshSample(MAX_SAMPLE_AGE_MS, sample, sampleAgeMs)){
+                controller->recordStaleDecision();
+                ESP_LOGE(TAG, "No DHT sample in the last %lu ms!", (unsigned long)MAX_SAMPLE_AGE_MS);
                 controller->turnOff(); // safe fallback
             }
             else{
-                float humidity = controller->dhtSensor->getHumidity();
-                if (humidity >= 0.0 && humidity <= 100.0) {  
+                controller->recordDecision(sample, sampleAgeMs);
+                DeciPercent humidity = sample.humidity;
+                char humidityText[DECI_TEXT_SIZE], thresholdText[DECI_TEXT_SIZE];
+                formatDeci(humidity.tenths, humidityText, sizeof(humidityText));
+                formatDeci(controller->humidityThreshold.tenths, thresholdText, sizeof(thresholdText));
+                if (humidity >= MIN_HUMIDITY && humidity <= MAX_HUMIDITY) {  
                     if(humidity < controller->humidityThreshold){
                         controller->turnOff();
-                        ESP_LOGI(TAG, "[AUTO] Room humidity %.2f%% below threshold %.2f%%, Humidifier: OFF", 
-                               humidity, controller->humidityThreshold);
+                        ESP_LOGI(TAG, "[AUTO] Room humidity %s%% below threshold %s%% (sample #%lu, %lu ms old), Humidifier: OFF", 
+                               humidityText, thresholdText, (unsigned long)sample.sequence, (unsigned long)sampleAgeMs);
                     }
                     else{
                         controller->turnOn();
-                        ESP_LOGI(TAG, "[AUTO] Room humidity %.2f%% above threshold %.2f%%, Humidifier: ON", 
-                               humidity, controller->humidityThreshold);  
+                        ESP_LOGI(TAG, "[AUTO] Room humidity %s%% above threshold %s%% (sample #%lu, %lu ms old), Humidifier: ON", 
+                               humidityText, thresholdText, (unsigned long)sample.sequence, (unsigned long)sampleAgeMs);  
                     }
                 } else {
-                    ESP_LOGW(TAG, "Invalid humidity reading: %.2f, skipping humidifier control", humidity);
+                    ESP_LOGW(TAG, "Invalid humidity reading: %s, skipping humidifier control", humidityText);
                     // Keep previous humidifier state
                 }
                 
             }
         } 
         else {
-            // MANUAL MODE: Control based on manual switch state (V2)
-            bool manualSwitchOn = controller->blynkManager->isManualSwitchOn();
+            // MANUAL MODE: Control based on manual switch state (V2); the
+            // switch is tracked in auto mode as well but only applied here
+            bool manualSwitchOn = config.manualSwitchOn;
             
             if (manualSwitchOn) {
                 controller->turnOn();
@@ -129,6 +218,12 @@ void HumidifierController::HMD_ControlTask(void* pvParameters){
             }
         }
         
-        vTaskDelay(xDelay);
+        // Sleep until a new sample or a remote change (see notifyControlChanged());
+        // the timeout only fires when the sensor stops publishing
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(MAX_SAMPLE_AGE_MS));
+        if(events & NOTIFY_CONTROL_CHANGED){
+            ESP_LOGI(TAG, "Woken by a remote control change");
+        }
     }
 }
\ No newline at end of file
@@ -2,30 +2,63 @@
 #pragma once
 #include <pinDefinitions.hpp>
 #include "driver/gpio.h"
+#include "ClimateSource.hpp"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
-class DHTSensor;
 class BlynkManager;  
 
 class HumidifierController {
 public:
+    // How old the sensor sample was when auto mode acted on it
+    struct DecisionStats {
+        uint32_t decisions;         // auto-mode decisions made on a fresh sample
+        uint32_t newSamples;        // decisions that saw a sample for the first time
+        uint32_t staleFallbacks;    // no fresh sample, humidifier forced off
+        uint32_t lastSequence;
+        uint32_t lastSampleAgeMs;
+        uint32_t averageSampleAgeMs;
+        uint32_t maxSampleAgeMs;
+    };
+
     void turnOn(void);
     void turnOff(void);
     bool getState() const;  //Read-only access to state
 
-    explicit HumidifierController(DHTSensor* dhtSensor, BlynkManager* blynkManager, gpio_num_t humPin);
+    explicit HumidifierController(ClimateSource* climateSource, BlynkManager* blynkManager, gpio_num_t humPin);
     void start();  
+    void setHumidityThreshold(DeciPercent threshold);
+    DeciPercent getHumidityThresholdDeci() const;
+    // Float adapters
     void setHumidityThreshold(float threshold);
     float getHumidityThreshold() const;
+    // Wakes the control task to re-evaluate right away, e.g. after a remote
+    // mode, switch or threshold change (otherwise it runs on each new sample)
+    void notifyControlChanged();
+    // Wakes the control task when Blynk becomes reachable or unreachable
+    void notifyCloudStateChanged();
+    DecisionStats getDecisionStats() const;
 
 private:
+    // Auto mode ignores samples older than this and fails safe (off)
+    static constexpr uint32_t MAX_SAMPLE_AGE_MS = ClimateSource::DEFAULT_MAX_SAMPLE_AGE_MS;
+    // Control task notification bits
+    static constexpr uint32_t NOTIFY_CONTROL_CHANGED = 1UL << 0;
+    static constexpr uint32_t NOTIFY_NEW_SAMPLE = 1UL << 1;
+    static constexpr uint32_t NOTIFY_CLOUD_STATE = 1UL << 2;
+
     void conf_HumidifierGPIO(); 
-    DHTSensor* dhtSensor; 
+    ClimateSource* climateSource; 
     BlynkManager* blynkManager; 
     gpio_num_t humControlPin;  //Stores GPIO pin
     bool humidifierState;  //Flag to store ON/OFF state
+    TaskHandle_t controlTaskHandle;
     static void HMD_ControlTask(void* pvParameters); 
-    float humidityThreshold = 60.0f;
+    static void onNewSample(void* context, const ClimateSample& sample);
+    DeciPercent humidityThreshold = DeciPercent::fromTenths(600);
+    DecisionStats decisionStats;
+    uint64_t totalSampleAgeMs;
+    void recordDecision(const ClimateSample& sample, uint32_t sampleAgeMs);
+    void recordStaleDecision();
 };
@@ -6,11 +6,13 @@
 #include "esp_spi_flash.h"
 #include "pinDefinitions.hpp"
 #include "DHTSensor.hpp"
+#include "DHTSensorGroup.hpp"
 #include "HumidifierController.hpp"
 #include "WIFIManager.hpp"
 #include "BlynkManager.hpp"
 #include "PixelManager.hpp"
 #include "esp_log.h"
+#include "esp_netif_sntp.h"
 #include "Private.hpp"
 
 extern "C" {
@@ -20,9 +22,20 @@ extern "C" {
 void app_main(void) {
     // Print system info
     
-    //Init DHT
+    //Init DHT, one sensor or a fused group
+#ifdef DHT_SENSOR_PINS
+    static DHTSensorGroup dhtSensors;
+    static const gpio_num_t dhtPins[] = { DHT_SENSOR_PINS };
+    for (gpio_num_t pin : dhtPins) {
+        dhtSensors.addSensor(pin);
+    }
+    dhtSensors.start();
+    ClimateSource* climateSource = &dhtSensors;
+#else
     static DHTSensor dhtSensor(DHT_SENSOR);
     dhtSensor.start();
+    ClimateSource* climateSource = &dhtSensor;
+#endif
 
     // Init WiFi
     static WIFIManager wifiManager(WIFI_SSID, WIFI_PASSWORD);
@@ -31,20 +44,36 @@ void app_main(void) {
      if(wifiManager.isConnectedToWifi()){
         ESP_LOGI("Main", "WIFI:Connected!");
      }
+
+    //Wall clock for timestamping buffered telemetry
+    esp_sntp_config_t sntpConfig = ESP_NETIF_SNTP_DEFAULT_CONFIG("pool.ntp.org");
+    esp_netif_sntp_init(&sntpConfig);
     
     //PixelManager instance
     static PixelManager pixelManager(PIXEL_LED_PIN, NUM_LEDS);
     pixelManager.start();
 
-    static BlynkManager blynkManager(BLYNK_AUTH_TOKEN, BLYNK_SERVER, &dhtSensor, nullptr, &pixelManager);
-    blynkManager.start();
-    blynkManager.fetchControlMode();
-    //syncing data
-    if(!blynkManager.isAutoMode()){
-        blynkManager.fetchManualSwitchState();
+    static BlynkManager blynkManager(BLYNK_AUTH_TOKEN, BLYNK_SERVER, climateSource, nullptr, &pixelManager);
+#ifdef BLYNK_FALLBACK_SERVERS
+    static const char* const fallbackServers[] = { BLYNK_FALLBACK_SERVERS };
+    for (const char* server : fallbackServers) {
+        blynkManager.addCandidateServer(server);
     }
+#endif
+#ifdef BLYNK_CA_CERT_PEM
+    blynkManager.setServerCertificate(BLYNK_CA_CERT_PEM);
+#endif
+#ifdef BLYNK_TCP_HOST
+    blynkManager.enableHardwareProtocol(BLYNK_TCP_HOST, BLYNK_TCP_PORT);
+#elif defined(BLYNK_MQTT_URI)
+    blynkManager.enableMqtt(BLYNK_MQTT_URI, BLYNK_MQTT_QOS);
+#endif
+    blynkManager.enableTelemetrySpill();
+    blynkManager.start();
+    //syncing mode, switch and threshold in one request
+    blynkManager.fetchPins(VirtualPinSpec::GROUP_CONTROL);
 
-    static HumidifierController humidifierController(&dhtSensor, &blynkManager, HUMIDIFIER_SENSOR);
+    static HumidifierController humidifierController(climateSource, &blynkManager, HUMIDIFIER_SENSOR);
     blynkManager.setHumidifierController(&humidifierController);
     humidifierController.start();
     ESP_LOGI("Main", "Auto-Humidifier System starts working");
@@ -8,6 +8,7 @@ static const char* TAG = "PixelManager";
 PixelManager::PixelManager(uint8_t PIXEL_LED_PIN, uint16_t NUM_LEDS)
     : pixelPin(PIXEL_LED_PIN), numLeds(NUM_LEDS),
       current_mode(Mode::OFF), red(0), green(0), blue(0), brightness(50),
+      controlConfig(nullptr), appliedConfigVersion(0),
       pixelTaskHandle(nullptr), eventQueue(nullptr), stripMutex(nullptr),
       animationTimer(nullptr), taskRunning(false), shutdownRequested(false),
       lastAnimationTime(0), breathingPhase(0.0f), rainbowStartHue(0), oceanWaveOffset(0) {
@@ -166,33 +167,27 @@ void PixelManager::pixelTask() {
                     
                 case EVENT_MODE_CHANGE:
                     ESP_LOGI(TAG, "Mode change event: %d", event.data.mode);
-                    current_mode = event.data.mode;
-                    // Reset animation state when mode changes
-                    breathingPhase = 0.0f;
-                    rainbowStartHue = 0;
-                    oceanWaveOffset = 0;
-                    refreshLEDStrip();
+                    changeMode(event.data.mode);
                     break;
                     
                 case EVENT_COLOR_CHANGE:
                     ESP_LOGI(TAG, "Color change event: R:%d G:%d B:%d", 
                             event.data.color.r, event.data.color.g, event.data.color.b);
-                    red = event.data.color.r;
-                    green = event.data.color.g;
-                    blue = event.data.color.b;
-                    if (current_mode == SOLID || current_mode == BREATHING) {
-                        refreshLEDStrip();
-                    }
+                    changeColour(event.data.color.r, event.data.color.g, event.data.color.b);
                     break;
                     
                 case EVENT_BRIGHTNESS_CHANGE:
                     ESP_LOGI(TAG, "Brightness change event: %d", event.data.brightness);
-                    brightness = event.data.brightness;
-                    refreshLEDStrip();
+                    changeBrightness(event.data.brightness);
                     break;
             }
         }
 
+        // App settings published by BlynkManager
+        if (applyControlConfig()) {
+            eventReceived = true;
+        }
+
         // Handle animations for modes that need continuous updates
         Mode currentMode = current_mode.load();
         if (currentMode == RAINBOW_RING || currentMode == OCEAN_WAVE || currentMode == BREATHING) {
@@ -215,6 +210,69 @@ task_exit:
     vTaskDelete(nullptr);
 }
 
+void PixelManager::changeMode(Mode mode) {
+    current_mode = mode;
+    // Reset animation state when mode changes
+    breathingPhase = 0.0f;
+    rainbowStartHue = 0;
+    oceanWaveOffset = 0;
+    refreshLEDStrip();
+}
+
+void PixelManager::changeColour(uint8_t r, uint8_t g, uint8_t b) {
+    red = r;
+    green = g;
+    blue = b;
+    if (current_mode == SOLID || current_mode == BREATHING) {
+        refreshLEDStrip();
+    }
+}
+
+void PixelManager::changeBrightness(uint8_t value) {
+    brightness = value;
+    refreshLEDStrip();
+}
+
+void PixelManager::followConfig(const SharedControlConfig* config) {
+    controlConfig = config;
+}
+
+bool PixelManager::applyControlConfig() {
+    const SharedControlConfig* shared = controlConfig.load();
+    if (shared == nullptr || shared->getVersion() == appliedConfigVersion) {
+        return false;
+    }
+
+    ControlConfig config;
+    appliedConfigVersion = shared->read(config);
+    bool changed = false;
+
+    if (config.has(ControlConfig::FIELD_PIXEL_MODE) && config.pixelMode != current_mode.load()) {
+        if (config.pixelMode < MODE_COUNT) {
+            ESP_LOGI(TAG, "Mode from Blynk: %d", config.pixelMode);
+            changeMode(static_cast<Mode>(config.pixelMode));
+            changed = true;
+        } else {
+            ESP_LOGW(TAG, "Invalid mode value from Blynk: %d", config.pixelMode);
+        }
+    }
+
+    if (config.has(ControlConfig::FIELD_BRIGHTNESS) && config.pixelBrightness != brightness.load()) {
+        ESP_LOGI(TAG, "Brightness from Blynk: %d", config.pixelBrightness);
+        changeBrightness(config.pixelBrightness);
+        changed = true;
+    }
+
+    if (config.has(ControlConfig::FIELD_COLOUR)
+        && (config.red != red.load() || config.green != green.load() || config.blue != blue.load())) {
+        ESP_LOGI(TAG, "Color from Blynk: R:%d G:%d B:%d", config.red, config.green, config.blue);
+        changeColour(config.red, config.green, config.blue);
+        changed = true;
+    }
+
+    return changed;
+}
+
 bool PixelManager::sendEvent(const PixelEvent& event) {
     if (eventQueue == nullptr) {
         return false;
@@ -9,6 +9,7 @@
 #include "freertos/semphr.h"
 #include "freertos/timers.h"
 #include <pinDefinitions.hpp>
+#include "ControlConfig.hpp"
 #include <string>
 #include <cmath>
 #include <atomic>
@@ -56,6 +57,10 @@ public:
     void setBrightness(uint8_t value);
     void setColourFromBlynk(uint8_t r, uint8_t g, uint8_t b);
     void updateModeFromBlynk(int value);
+
+    // Picks up pixel mode, brightness and colour from the shared app
+    // settings; the task only copies them when their version changed
+    void followConfig(const SharedControlConfig* config);
     
     // Get task statistics for monitoring
     uint32_t getTaskHighWaterMark() const;
@@ -74,6 +79,12 @@ private:
     void applyOceanWaveMode();
     void applyBreathingMode();
 
+    // State changes, run on the pixel task
+    void changeMode(Mode mode);
+    void changeColour(uint8_t r, uint8_t g, uint8_t b);
+    void changeBrightness(uint8_t value);
+    bool applyControlConfig();
+
     // Utility functions
     void hsvToRgb(uint16_t h, uint8_t s, uint8_t v, uint8_t& r, uint8_t& g, uint8_t& b);
     bool sendEvent(const PixelEvent& event);
@@ -87,6 +98,10 @@ private:
     std::atomic<Mode> current_mode;
     std::atomic<uint8_t> red, green, blue;
     std::atomic<uint8_t> brightness;
+
+    // Shared app settings, and the version last applied (pixel task only)
+    std::atomic<const SharedControlConfig*> controlConfig;
+    uint32_t appliedConfigVersion;
     
     // RTOS components
     TaskHandle_t pixelTaskHandle;
@@ -12,6 +12,16 @@
 // // Blynk Configuration
 // #define BLYNK_AUTH_TOKEN "YOUR_AUTH_TOKEN"
 // #define BLYNK_SERVER "http://blynk.cloud"
+// // Optional: other regional servers, the fastest reachable one is used
+// #define BLYNK_FALLBACK_SERVERS "http://fra1.blynk.cloud", "http://sgp1.blynk.cloud"
+// // Optional: persistent TCP hardware protocol instead of HTTP polling
+// #define BLYNK_TCP_HOST "blynk.cloud"
+// #define BLYNK_TCP_PORT 80
+// // Optional: MQTT push instead (a local mosquitto URI works for testing)
+// #define BLYNK_MQTT_URI "mqtt://blynk.cloud:1883"
+// #define BLYNK_MQTT_QOS 1
+// // Optional: with an https:// server, trust this PEM instead of the bundled CAs
+// #define BLYNK_CA_CERT_PEM "-----BEGIN CERTIFICATE-----\n...\n-----END CERTIFICATE-----\n"
 
 
 // #define WIFI_SSID "C-Net Sreedharan"
@@ -0,0 +1,92 @@
+//SamplingScheduler.cpp
+#include "SamplingScheduler.hpp"
+
+SamplingScheduler::SamplingScheduler(uint32_t periodMs, uint32_t minSpacingMs, uint32_t maxRetries)
+    : periodMs(periodMs > 0 ? periodMs : 1), minSpacingMs(minSpacingMs), maxRetries(maxRetries),
+      gridSlotMs(0), slotMs(0), retriesThisPeriod(0), sampledThisPeriod(false),
+      haveSample(false), lastSampleMs(0), periodCount(0), periodTotalMs(0), jitterTotalMs(0), stats{} {
+}
+
+void SamplingScheduler::start(uint32_t nowMs) {
+    gridSlotMs = nowMs;
+    slotMs = nowMs;
+    retriesThisPeriod = 0;
+    sampledThisPeriod = false;
+}
+
+uint32_t SamplingScheduler::nextSlotMs() const {
+    return slotMs;
+}
+
+void SamplingScheduler::recordAttempt(bool success, uint32_t sampleMs) {
+    stats.attempts++;
+
+    // Spacing is kept between slots; a read that began noticeably after its
+    // slot counts from when it actually began
+    uint32_t startMs = isBefore(slotMs + LATE_TOLERANCE_MS, sampleMs) ? sampleMs : slotMs;
+
+    if (success) {
+        stats.samples++;
+        sampledThisPeriod = true;
+        recordPeriod(sampleMs);
+        advanceGrid(startMs);
+        return;
+    }
+
+    // A retry slot must keep its spacing to both this read and the next grid slot
+    uint32_t retrySlotMs = startMs + minSpacingMs;
+    if (retriesThisPeriod < maxRetries && !isBefore(gridSlotMs + periodMs, retrySlotMs + minSpacingMs)) {
+        retriesThisPeriod++;
+        stats.retries++;
+        slotMs = retrySlotMs;
+        return;
+    }
+
+    advanceGrid(startMs);
+}
+
+SamplingScheduler::Stats SamplingScheduler::getStats() const {
+    Stats result = stats;
+    result.retryRatePermille = stats.attempts > 0 ? (uint32_t)((uint64_t)stats.retries * 1000 / stats.attempts) : 0;
+    result.averagePeriodMs = periodCount > 0 ? (uint32_t)(periodTotalMs / periodCount) : 0;
+    result.averageJitterMs = periodCount > 0 ? (uint32_t)(jitterTotalMs / periodCount) : 0;
+    return result;
+}
+
+bool SamplingScheduler::isBefore(uint32_t a, uint32_t b) {
+    // Wrap-safe for times less than ~24 days apart
+    return (int32_t)(a - b) < 0;
+}
+
+void SamplingScheduler::advanceGrid(uint32_t startMs) {
+    if (!sampledThisPeriod) {
+        stats.missedPeriods++;
+    }
+
+    // Next grid slot, skipping any too close to the read that just ran
+    gridSlotMs += periodMs;
+    while (isBefore(gridSlotMs, startMs + minSpacingMs)) {
+        gridSlotMs += periodMs;
+        stats.overruns++;
+    }
+
+    slotMs = gridSlotMs;
+    retriesThisPeriod = 0;
+    sampledThisPeriod = false;
+}
+
+void SamplingScheduler::recordPeriod(uint32_t sampleMs) {
+    if (haveSample) {
+        uint32_t period = sampleMs - lastSampleMs;
+        uint32_t jitter = period > periodMs ? period - periodMs : periodMs - period;
+        stats.lastPeriodMs = period;
+        periodTotalMs += period;
+        jitterTotalMs += jitter;
+        periodCount++;
+        if (jitter > stats.maxJitterMs) {
+            stats.maxJitterMs = jitter;
+        }
+    }
+    haveSample = true;
+    lastSampleMs = sampleMs;
+}
@@ -0,0 +1,62 @@
+//SamplingScheduler.hpp
+#pragma once
+
+#include <cstdint>
+
+// Time slots for reading a sensor at a fixed cadence. Regular slots sit on
+// an absolute grid (start + n * period), so a slow or failed read never
+// shifts later samples. A failed read may be retried in extra slots between
+// two grid slots, as long as every slot stays minSpacingMs away from its
+// neighbours. Times are in ms on any monotonic clock. Not thread safe.
+class SamplingScheduler {
+public:
+    struct Stats {
+        uint32_t samples;          // successful reads
+        uint32_t attempts;         // all reads, retries included
+        uint32_t retries;
+        uint32_t missedPeriods;    // periods that ended without a sample
+        uint32_t overruns;         // grid slots skipped because a read ran late
+        uint32_t retryRatePermille;
+        uint32_t lastPeriodMs;     // time between the last two samples
+        uint32_t averagePeriodMs;
+        uint32_t averageJitterMs;  // mean |achieved period - period|
+        uint32_t maxJitterMs;
+    };
+
+    SamplingScheduler(uint32_t periodMs, uint32_t minSpacingMs, uint32_t maxRetries);
+
+    // First slot is `nowMs`
+    void start(uint32_t nowMs);
+
+    // Absolute time of the next read
+    uint32_t nextSlotMs() const;
+
+    // Records the outcome of the read made for nextSlotMs() and schedules
+    // the next slot; sampleMs is when the read actually began
+    void recordAttempt(bool success, uint32_t sampleMs);
+
+    Stats getStats() const;
+
+private:
+    static constexpr uint32_t LATE_TOLERANCE_MS = 50;  // wake-up slack still counted as on time
+
+    static bool isBefore(uint32_t a, uint32_t b);
+    void advanceGrid(uint32_t startMs);
+    void recordPeriod(uint32_t sampleMs);
+
+    uint32_t periodMs;
+    uint32_t minSpacingMs;
+    uint32_t maxRetries;
+
+    uint32_t gridSlotMs;       // regular slot of the current period
+    uint32_t slotMs;           // next read, a grid or retry slot
+    uint32_t retriesThisPeriod;
+    bool sampledThisPeriod;
+
+    bool haveSample;
+    uint32_t lastSampleMs;
+    uint32_t periodCount;
+    uint64_t periodTotalMs;
+    uint64_t jitterTotalMs;
+    Stats stats;
+};
@@ -0,0 +1,67 @@
+//SensorBus.cpp
+#include "SensorBus.hpp"
+#include "ClimateSource.hpp"
+#include "esp_log.h"
+
+static const char* TAG = "SensorBus";
+
+SensorBus::SensorBus() : subscribers{}, subscriberCount(0), published(0), dropped(0) {
+    subscribeMutex = xSemaphoreCreateMutex();
+    if (subscribeMutex == nullptr) {
+        ESP_LOGE(TAG, "Failed to create subscribe mutex");
+    }
+}
+
+bool SensorBus::subscribe(SampleHandler handler, void* context) {
+    if (handler == nullptr) {
+        return false;
+    }
+    return addSubscriber(Subscriber{ handler, context, nullptr });
+}
+
+bool SensorBus::subscribe(QueueHandle_t queue) {
+    if (queue == nullptr) {
+        return false;
+    }
+    return addSubscriber(Subscriber{ nullptr, nullptr, queue });
+}
+
+bool SensorBus::addSubscriber(const Subscriber& subscriber) {
+    xSemaphoreTake(subscribeMutex, portMAX_DELAY);
+    int count = subscriberCount.load(std::memory_order_relaxed);
+    bool added = count < MAX_SUBSCRIBERS;
+    if (added) {
+        // Fill the slot before publishing the new count to the sensor task
+        subscribers[count] = subscriber;
+        subscriberCount.store(count + 1, std::memory_order_release);
+    }
+    xSemaphoreGive(subscribeMutex);
+
+    if (!added) {
+        ESP_LOGE(TAG, "All %d subscriber slots taken", MAX_SUBSCRIBERS);
+    }
+    return added;
+}
+
+void SensorBus::publish(const ClimateSample& sample) {
+    published.fetch_add(1, std::memory_order_relaxed);
+
+    int count = subscriberCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        const Subscriber& subscriber = subscribers[i];
+        if (subscriber.handler != nullptr) {
+            subscriber.handler(subscriber.context, sample);
+        }
+        else if (xQueueSend(subscriber.queue, &sample, 0) != pdTRUE) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+uint32_t SensorBus::getPublishedCount() const {
+    return published.load(std::memory_order_relaxed);
+}
+
+uint32_t SensorBus::getDroppedCount() const {
+    return dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,49 @@
+//SensorBus.hpp
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <atomic>
+#include <cstdint>
+
+struct ClimateSample;
+
+// Delivers each new sensor sample once to every subscriber, so consumers
+// wake when data arrives instead of polling on their own timers. Handlers
+// run on the publishing sensor task and must not block; a task that waits
+// on several events typically just sets a notification bit from its handler.
+// Subscribing is fixed-size and meant for startup; publishing takes no lock.
+class SensorBus {
+public:
+    typedef void (*SampleHandler)(void* context, const ClimateSample& sample);
+
+    static constexpr int MAX_SUBSCRIBERS = 4;
+
+    SensorBus();
+
+    bool subscribe(SampleHandler handler, void* context);
+    // Samples are copied into a queue of ClimateSample items without
+    // waiting; when the queue is full the new sample is dropped and counted
+    bool subscribe(QueueHandle_t queue);
+
+    void publish(const ClimateSample& sample);
+
+    uint32_t getPublishedCount() const;
+    uint32_t getDroppedCount() const;
+
+private:
+    struct Subscriber {
+        SampleHandler handler;  // null for queue subscribers
+        void* context;
+        QueueHandle_t queue;
+    };
+
+    bool addSubscriber(const Subscriber& subscriber);
+
+    Subscriber subscribers[MAX_SUBSCRIBERS];
+    std::atomic<int> subscriberCount;
+    SemaphoreHandle_t subscribeMutex;
+    std::atomic<uint32_t> published;
+    std::atomic<uint32_t> dropped;
+};
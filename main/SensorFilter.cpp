@@ -0,0 +1,153 @@
+//SensorFilter.cpp
+#include "SensorFilter.hpp"
+
+SensorFilter::Config SensorFilter::none() {
+    return Config{ FILTER_NONE, 1, 0, 0, 0 };
+}
+
+SensorFilter::Config SensorFilter::median(uint8_t window) {
+    return Config{ FILTER_MEDIAN, window, 0, 0, 0 };
+}
+
+SensorFilter::Config SensorFilter::ema(uint16_t alphaQ15) {
+    return Config{ FILTER_EMA, 1, alphaQ15, 0, 0 };
+}
+
+SensorFilter::Config SensorFilter::kalman(uint32_t processNoise, uint32_t measurementNoise) {
+    return Config{ FILTER_KALMAN, 1, 0, processNoise, measurementNoise };
+}
+
+SensorFilter::SensorFilter() {
+    configure(none());
+}
+
+void SensorFilter::configure(const Config& newConfig) {
+    config = newConfig;
+    if (config.window < 1) {
+        config.window = 1;
+    }
+    if (config.window > MAX_WINDOW) {
+        config.window = MAX_WINDOW;
+    }
+    if (config.emaAlphaQ15 == 0 || config.emaAlphaQ15 > (1u << GAIN_SHIFT)) {
+        config.emaAlphaQ15 = 1u << GAIN_SHIFT;
+    }
+    reset();
+}
+
+void SensorFilter::reset() {
+    seeded = false;
+    value = 0;
+    ringHead = 0;
+    ringCount = 0;
+    state = 0;
+    variance = 0;
+}
+
+int32_t SensorFilter::update(int32_t rawTenths) {
+    switch (config.type) {
+        case FILTER_MEDIAN:
+            value = updateMedian(rawTenths);
+            break;
+        case FILTER_EMA:
+            value = updateEma(rawTenths);
+            break;
+        case FILTER_KALMAN:
+            value = updateKalman(rawTenths);
+            break;
+        default:
+            value = rawTenths;
+            break;
+    }
+    seeded = true;
+    return value;
+}
+
+int32_t SensorFilter::getValue() const {
+    return value;
+}
+
+bool SensorFilter::hasValue() const {
+    return seeded;
+}
+
+const SensorFilter::Config& SensorFilter::getConfig() const {
+    return config;
+}
+
+int32_t SensorFilter::updateMedian(int32_t rawTenths) {
+    size_t window = config.window;
+
+    // Drop the sample leaving the window from the sorted copy...
+    size_t count = ringCount;
+    if (count == window) {
+        int32_t oldest = ring[ringHead];
+        size_t i = 0;
+        while (sorted[i] != oldest) {
+            ++i;
+        }
+        for (; i + 1 < count; ++i) {
+            sorted[i] = sorted[i + 1];
+        }
+        --count;
+    }
+    else {
+        ++ringCount;
+    }
+
+    // ...and insert the new one in place
+    size_t i = count;
+    while (i > 0 && sorted[i - 1] > rawTenths) {
+        sorted[i] = sorted[i - 1];
+        --i;
+    }
+    sorted[i] = rawTenths;
+
+    ring[ringHead] = rawTenths;
+    ringHead = (ringHead + 1) % window;
+
+    if (ringCount % 2 == 1) {
+        return sorted[ringCount / 2];
+    }
+    return (sorted[ringCount / 2 - 1] + sorted[ringCount / 2]) / 2;
+}
+
+int32_t SensorFilter::updateEma(int32_t rawTenths) {
+    int64_t sample = (int64_t)rawTenths << STATE_SHIFT;
+    if (!seeded) {
+        state = sample;
+    }
+    else {
+        state += ((sample - state) * config.emaAlphaQ15) >> GAIN_SHIFT;
+    }
+    return roundState(state);
+}
+
+int32_t SensorFilter::updateKalman(int32_t rawTenths) {
+    int64_t sample = (int64_t)rawTenths << STATE_SHIFT;
+    int64_t measurementNoise = (int64_t)config.measurementNoise << STATE_SHIFT;
+    if (!seeded) {
+        state = sample;
+        variance = measurementNoise;
+        return rawTenths;
+    }
+
+    // Predict: the value may have drifted since the last sample
+    variance += (int64_t)config.processNoise << STATE_SHIFT;
+
+    // Correct: gain = P / (P + R) in Q15
+    int64_t denominator = variance + measurementNoise;
+    int64_t gain = denominator > 0 ? (variance << GAIN_SHIFT) / denominator : (1 << GAIN_SHIFT);
+    state += ((sample - state) * gain) >> GAIN_SHIFT;
+    variance = (variance * ((1 << GAIN_SHIFT) - gain)) >> GAIN_SHIFT;
+    return roundState(state);
+}
+
+int32_t SensorFilter::roundState(int64_t fixedState) {
+    // Round half away from zero; a plain shift would floor negative values
+    int64_t half = (int64_t)1 << (STATE_SHIFT - 1);
+    if (fixedState >= 0) {
+        return (int32_t)((fixedState + half) >> STATE_SHIFT);
+    }
+    return -(int32_t)((-fixedState + half) >> STATE_SHIFT);
+}
@@ -0,0 +1,70 @@
+//SensorFilter.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Streaming smoother for one sensor channel. Works on integer tenths as
+// delivered by the DHT driver, in fixed point throughout, with constant
+// time and memory per sample. Depends on nothing from IDF so it can be
+// built and timed on the host. Not thread safe: one owner task.
+class SensorFilter {
+public:
+    enum Type : uint8_t {
+        FILTER_NONE = 0,
+        FILTER_MEDIAN,    // median of the last `window` samples
+        FILTER_EMA,       // exponential moving average
+        FILTER_KALMAN     // 1-D Kalman, constant-value model
+    };
+
+    static constexpr size_t MAX_WINDOW = 7;
+
+    struct Config {
+        Type type;
+        uint8_t window;            // MEDIAN: 1..MAX_WINDOW, odd values avoid averaging
+        uint16_t emaAlphaQ15;      // EMA: weight of the new sample, 1..32768 (= 1.0)
+        uint32_t processNoise;     // KALMAN: drift variance per sample, tenths^2
+        uint32_t measurementNoise; // KALMAN: sensor variance, tenths^2
+    };
+
+    static Config none();
+    static Config median(uint8_t window);
+    static Config ema(uint16_t alphaQ15);
+    static Config kalman(uint32_t processNoise, uint32_t measurementNoise);
+
+    SensorFilter();
+
+    // Clears the history; the next sample seeds the filter
+    void configure(const Config& config);
+    void reset();
+
+    // Feeds one raw sample and returns the filtered value, both in tenths
+    int32_t update(int32_t rawTenths);
+
+    int32_t getValue() const;
+    bool hasValue() const;
+    const Config& getConfig() const;
+
+private:
+    static constexpr int STATE_SHIFT = 8;   // EMA/Kalman state in 1/256 tenths
+    static constexpr int GAIN_SHIFT = 15;
+
+    int32_t updateMedian(int32_t rawTenths);
+    int32_t updateEma(int32_t rawTenths);
+    int32_t updateKalman(int32_t rawTenths);
+    static int32_t roundState(int64_t state);
+
+    Config config;
+    bool seeded;
+    int32_t value;
+
+    // Median: samples in arrival order and the same samples kept sorted
+    int32_t ring[MAX_WINDOW];
+    int32_t sorted[MAX_WINDOW];
+    size_t ringHead;
+    size_t ringCount;
+
+    // EMA estimate, or Kalman estimate and its variance
+    int64_t state;
+    int64_t variance;
+};
@@ -0,0 +1,188 @@
+//TelemetryBuffer.cpp
+#include "TelemetryBuffer.hpp"
+#include "esp_log.h"
+#include <cstdio>
+
+static const char* TAG = "TelemetryBuffer";
+
+TelemetryBuffer::TelemetryBuffer()
+    : ram{}, ramTail(0), ramCount(0), spillEnabled(false), spillHandle(0), spillTailBlock(0),
+      spillBlockCount(0), spillCache{}, spillCacheOffset(0), spillCacheLoaded(false),
+      tailSeq(0), dropped(0), spilled(0) {}
+
+TelemetryBuffer::~TelemetryBuffer() {
+    if (spillEnabled) {
+        nvs_close(spillHandle);
+    }
+}
+
+esp_err_t TelemetryBuffer::enableSpill(const char* nvsNamespace) {
+    if (spillEnabled) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = nvs_open(nvsNamespace, NVS_READWRITE, &spillHandle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS namespace %s: %s", nvsNamespace, esp_err_to_name(err));
+        return err;
+    }
+
+    nvs_erase_all(spillHandle);
+    nvs_commit(spillHandle);
+    spillEnabled = true;
+    return ESP_OK;
+}
+
+void TelemetryBuffer::push(uint32_t uptimeMs, int32_t tenths) {
+    if (ramCount == RAM_CAPACITY) {
+        if (!spillEnabled || !spillOldest()) {
+            popOldest();
+            dropped++;
+        }
+    }
+
+    ram[(ramTail + ramCount) % RAM_CAPACITY] = Sample{ uptimeMs, tenths };
+    ramCount++;
+}
+
+size_t TelemetryBuffer::peek(Sample* out, size_t maxSamples, uint32_t& firstSeq) {
+    firstSeq = tailSeq;
+
+    // Flash holds everything older than RAM, so it drains first
+    if (spillBlockCount > 0) {
+        if (!loadSpillBlock()) {
+            return 0;
+        }
+        size_t count = 0;
+        while (count < maxSamples && spillCacheOffset + count < SPILL_BLOCK) {
+            out[count] = spillCache[spillCacheOffset + count];
+            count++;
+        }
+        return count;
+    }
+
+    size_t count = maxSamples < ramCount ? maxSamples : ramCount;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = ram[(ramTail + i) % RAM_CAPACITY];
+    }
+    return count;
+}
+
+void TelemetryBuffer::discardBefore(uint32_t endSeq) {
+    // Signed distance handles sequence wrap-around
+    while (!empty() && static_cast<int32_t>(endSeq - tailSeq) > 0) {
+        popOldest();
+    }
+}
+
+bool TelemetryBuffer::empty() const {
+    return depth() == 0;
+}
+
+uint32_t TelemetryBuffer::depth() const {
+    uint32_t flashSamples = spillBlockCount * SPILL_BLOCK - (spillCacheLoaded ? spillCacheOffset : 0);
+    return flashSamples + ramCount;
+}
+
+TelemetryBuffer::Stats TelemetryBuffer::getStats() const {
+    return Stats{ depth(), dropped, spilled };
+}
+
+// Moves the oldest RAM block to flash, evicting the oldest flash block when full
+bool TelemetryBuffer::spillOldest() {
+    if (spillBlockCount == MAX_SPILL_BLOCKS) {
+        dropOldestSpillBlock();
+    }
+
+    Sample block[SPILL_BLOCK];
+    for (size_t i = 0; i < SPILL_BLOCK; ++i) {
+        block[i] = ram[(ramTail + i) % RAM_CAPACITY];
+    }
+
+    char key[8];
+    makeKey(key, sizeof(key), spillTailBlock + spillBlockCount);
+    esp_err_t err = nvs_set_blob(spillHandle, key, block, sizeof(block));
+    if (err == ESP_OK) {
+        err = nvs_commit(spillHandle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Spill to NVS failed: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    // Sequence numbers stay put: the samples only change storage
+    ramTail = (ramTail + SPILL_BLOCK) % RAM_CAPACITY;
+    ramCount -= SPILL_BLOCK;
+    spillBlockCount++;
+    spilled += SPILL_BLOCK;
+    return true;
+}
+
+void TelemetryBuffer::dropOldestSpillBlock() {
+    uint32_t lost = SPILL_BLOCK - (spillCacheLoaded ? spillCacheOffset : 0);
+
+    char key[8];
+    makeKey(key, sizeof(key), spillTailBlock);
+    nvs_erase_key(spillHandle, key);
+
+    spillTailBlock++;
+    spillBlockCount--;
+    spillCacheLoaded = false;
+    spillCacheOffset = 0;
+    tailSeq += lost;
+    dropped += lost;
+}
+
+bool TelemetryBuffer::loadSpillBlock() {
+    if (spillCacheLoaded) {
+        return true;
+    }
+
+    char key[8];
+    makeKey(key, sizeof(key), spillTailBlock);
+    size_t size = sizeof(spillCache);
+    esp_err_t err = nvs_get_blob(spillHandle, key, spillCache, &size);
+    if (err != ESP_OK || size != sizeof(spillCache)) {
+        // Unreadable block: count it as dropped and move on
+        ESP_LOGW(TAG, "Failed to read spilled block %s: %s", key, esp_err_to_name(err));
+        dropOldestSpillBlock();
+        return false;
+    }
+
+    spillCacheLoaded = true;
+    spillCacheOffset = 0;
+    return true;
+}
+
+void TelemetryBuffer::popOldest() {
+    if (spillBlockCount > 0) {
+        if (!spillCacheLoaded) {
+            loadSpillBlock();
+            if (!spillCacheLoaded) {
+                return;  // block already dropped, tailSeq advanced
+            }
+        }
+
+        tailSeq++;
+        if (++spillCacheOffset == SPILL_BLOCK) {
+            char key[8];
+            makeKey(key, sizeof(key), spillTailBlock);
+            nvs_erase_key(spillHandle, key);
+            spillTailBlock++;
+            spillBlockCount--;
+            spillCacheLoaded = false;
+            spillCacheOffset = 0;
+        }
+        return;
+    }
+
+    if (ramCount > 0) {
+        ramTail = (ramTail + 1) % RAM_CAPACITY;
+        ramCount--;
+        tailSeq++;
+    }
+}
+
+void TelemetryBuffer::makeKey(char* key, size_t size, uint32_t block) const {
+    snprintf(key, size, "b%lu", (unsigned long)(block % MAX_SPILL_BLOCKS));
+}
@@ -0,0 +1,73 @@
+//TelemetryBuffer.hpp
+#pragma once
+
+#include "esp_err.h"
+#include "nvs.h"
+#include <cstddef>
+#include <cstdint>
+
+// Store-and-forward backlog for one telemetry pin. Samples collect in a RAM
+// ring while the link is down; with spill enabled, the oldest samples move to
+// NVS in fixed blocks once the ring fills, otherwise the oldest are dropped.
+// Every sample gets a sequence number so an upload can be acknowledged even
+// if older samples were dropped meanwhile. Not thread safe: one owner task.
+class TelemetryBuffer {
+public:
+    struct Sample {
+        uint32_t uptimeMs;
+        int32_t tenths;   // value in tenths of its unit
+    };
+
+    struct Stats {
+        uint32_t depth;      // samples waiting, RAM + flash
+        uint32_t dropped;    // oldest samples lost to a full buffer
+        uint32_t spilled;    // samples written to flash
+    };
+
+    static constexpr size_t RAM_CAPACITY = 64;
+    static constexpr size_t SPILL_BLOCK = 32;
+    static constexpr uint32_t MAX_SPILL_BLOCKS = 32;
+
+    TelemetryBuffer();
+    ~TelemetryBuffer();
+
+    // Opens (and clears) an NVS namespace for overflow. Samples carry uptime
+    // stamps, so anything left from a previous boot is meaningless.
+    esp_err_t enableSpill(const char* nvsNamespace);
+
+    void push(uint32_t uptimeMs, int32_t tenths);
+
+    // Copies up to maxSamples of the oldest samples (contiguous, from a single
+    // source) and returns how many; firstSeq receives the first one's sequence
+    size_t peek(Sample* out, size_t maxSamples, uint32_t& firstSeq);
+
+    // Removes every sample with a sequence number below endSeq
+    void discardBefore(uint32_t endSeq);
+
+    bool empty() const;
+    uint32_t depth() const;
+    Stats getStats() const;
+
+private:
+    bool spillOldest();
+    void dropOldestSpillBlock();
+    bool loadSpillBlock();
+    void popOldest();
+    void makeKey(char* key, size_t size, uint32_t block) const;
+
+    Sample ram[RAM_CAPACITY];
+    size_t ramTail;
+    size_t ramCount;
+
+    bool spillEnabled;
+    nvs_handle_t spillHandle;
+    uint32_t spillTailBlock;    // block index of the oldest spilled samples
+    uint32_t spillBlockCount;
+    Sample spillCache[SPILL_BLOCK];
+    size_t spillCacheOffset;    // samples of the tail block already consumed
+    bool spillCacheLoaded;
+
+    uint32_t tailSeq;           // sequence number of the oldest sample
+    uint32_t dropped;
+    uint32_t spilled;
+};
@@ -0,0 +1,37 @@
+//TlsHandshakeStats.cpp
+#include "TlsHandshakeStats.hpp"
+
+TlsHandshakeStats::TlsHandshakeStats() : stats{}, baselineCount(0), totalFullMs(0), totalResumedMs(0) {}
+
+void TlsHandshakeStats::record(uint32_t handshakeMs, bool sessionOffered) {
+    stats.handshakes++;
+    if (!sessionOffered) {
+        baselineCount++;
+        totalFullMs += handshakeMs;
+        stats.averageFullMs = static_cast<uint32_t>(totalFullMs / baselineCount);
+    } else {
+        stats.sessionOffers++;
+    }
+
+    // Without a full handshake to compare against there is no estimate
+    bool resumed = sessionOffered && baselineCount > 0
+                && static_cast<uint64_t>(handshakeMs) * 100 < static_cast<uint64_t>(stats.averageFullMs) * RESUMED_PERCENT;
+
+    if (resumed) {
+        stats.estimatedResumed++;
+        totalResumedMs += handshakeMs;
+        stats.averageResumedMs = static_cast<uint32_t>(totalResumedMs / stats.estimatedResumed);
+    } else {
+        stats.estimatedFull++;
+    }
+
+    stats.lastHandshakeMs = handshakeMs;
+    stats.lastEstimatedResumed = resumed;
+    if (handshakeMs > stats.maxHandshakeMs) {
+        stats.maxHandshakeMs = handshakeMs;
+    }
+}
+
+TlsHandshakeStats::Stats TlsHandshakeStats::getStats() const {
+    return stats;
+}
@@ -0,0 +1,43 @@
+//TlsHandshakeStats.hpp
+#pragma once
+
+#include <cstdint>
+
+// Counts TLS handshakes and estimates how many were resumed. Whether a saved
+// session was offered is known exactly; whether the server accepted it is
+// not, as esp_http_client does not expose its mbedTLS context. The estimate
+// goes by handshake time: an offered session counts as resumed when the
+// handshake took less than RESUMED_PERCENT of the average full one
+// (resumption skips the certificate chain and the key exchange, several
+// times faster on an ESP32). That average only learns from handshakes made
+// without a session, which are full for certain, so a misjudged handshake
+// does not move the line for the next ones.
+class TlsHandshakeStats {
+public:
+    static constexpr uint32_t RESUMED_PERCENT = 50;
+
+    struct Stats {
+        uint32_t handshakes;
+        uint32_t sessionOffers;       // handshakes made with a saved session to offer
+        uint32_t estimatedResumed;    // offers judged resumed by their time
+        uint32_t estimatedFull;       // everything else
+        uint32_t lastHandshakeMs;     // TCP connect + TLS handshake
+        bool lastEstimatedResumed;
+        uint32_t averageFullMs;       // of the handshakes made without a session
+        uint32_t averageResumedMs;    // of the ones estimated resumed
+        uint32_t maxHandshakeMs;
+    };
+
+    TlsHandshakeStats();
+
+    // sessionOffered: the client held a session from an earlier handshake
+    // with the same server, so this one may have been resumed
+    void record(uint32_t handshakeMs, bool sessionOffered);
+    Stats getStats() const;
+
+private:
+    Stats stats;
+    uint32_t baselineCount;
+    uint64_t totalFullMs;
+    uint64_t totalResumedMs;
+};
@@ -0,0 +1,74 @@
+//VersionedSnapshot.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Double-buffered snapshot of a small trivially copyable value. One writer
+// at a time publishes into the spare buffer and then bumps the version;
+// readers copy the current buffer without locking and retry if a publish
+// overlapped the copy (a seqlock: release fence before the writer's data
+// stores, acquire fence after the reader's loads). A reader never waits on
+// a writer that was preempted mid-publish, so a high priority reader cannot
+// stall behind a lower priority writer on the same core.
+template <typename T>
+class VersionedSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "Snapshot values are copied word by word");
+
+public:
+    explicit VersionedSnapshot(const T& initial) : version(0) {
+        store(0, initial);
+        store(1, initial);
+    }
+
+    // Writers must be serialized by the caller
+    void publish(const T& value) {
+        uint32_t next = version.load(std::memory_order_relaxed) + 1;
+        // Pairs with the reader's acquire fence: a reader that sees any word
+        // of this publish also sees the previous version bump, so a copy
+        // overlapping two publishes into the same buffer fails its re-check
+        std::atomic_thread_fence(std::memory_order_release);
+        store(next & 1, value);
+        version.store(next, std::memory_order_release);
+    }
+
+    // Copies a consistent snapshot and returns its version
+    uint32_t read(T& out) const {
+        uint32_t words[WORD_COUNT];
+        while (true) {
+            uint32_t current = version.load(std::memory_order_acquire);
+            const std::atomic<uint32_t>* slot = buffers[current & 1];
+            for (size_t i = 0; i < WORD_COUNT; ++i) {
+                words[i] = slot[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // The writer only touches this buffer again after bumping the version
+            if (version.load(std::memory_order_relaxed) == current) {
+                memcpy(&out, words, sizeof(T));
+                return current;
+            }
+        }
+    }
+
+    // Cheap check whether anything was published since a reader's last copy
+    uint32_t getVersion() const {
+        return version.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    void store(uint32_t slot, const T& value) {
+        uint32_t words[WORD_COUNT] = {};
+        memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORD_COUNT; ++i) {
+            buffers[slot][i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<uint32_t> version;
+    std::atomic<uint32_t> buffers[2][WORD_COUNT];
+};
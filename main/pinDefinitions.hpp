@@ -3,5 +3,7 @@
 #include "driver/gpio.h"
 
 #define DHT_SENSOR GPIO_NUM_25
+// Several DHT11s read as one fused value, e.g.
+// #define DHT_SENSOR_PINS DHT_SENSOR, GPIO_NUM_27, GPIO_NUM_32
 #define HUMIDIFIER_SENSOR GPIO_NUM_26
 #define PIXEL_LED_PIN GPIO_NUM_13
\ No newline at end of file